@@ -0,0 +1,122 @@
+// np32_bench.c
+// Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+//
+// Host benchmark suite for libneopixel32. Build and run with "make bench". The shared fixture lives here, the
+// benchmarks and checks of the modules in np32_bench_<module>.c. Exits with 1 if any check found a mismatch.
+
+#include "np32_bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+const uint16_t Bench_Sizes[BENCH_SIZE_COUNT] = { 64, 256, 1024, 2048 };
+
+// Overclocked WS2812B profile: 1.0us bit period, trimmed reset time.
+const NP32_Timing_t Bench_Fast_Timing = NP32_TIMING_INIT(72000000, 1000, 300, 650, 30000);
+
+const char *Bench_Encoding_Names[] = { "PWM", "SPI3", "SPI4", "PWM-prof" };
+
+NP32_Instance_t *Bench_Instance;
+volatile uint32_t Bench_Sink;
+uint32_t Bench_Mismatches;
+
+uint64_t Bench_Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000000ULL) + (uint64_t) ts.tv_nsec;
+}
+
+int8_t Bench_StartDMA(NP32_DMA_t *buf, uint16_t len)
+{
+    Bench_Sink += buf[len - 1];
+    NP32_DMAComplete_Callback(Bench_Instance);
+    return 0;
+}
+
+int8_t Bench_StopDMA(void)
+{
+    return 0;
+}
+
+void Bench_Random_Fill(NP32_Instance_t *handle)
+{
+    uint16_t i;
+
+    for (i = 0; i < handle->LED_Count; i++)
+        NP32_SetLED_RGB(handle, i, (NP32_RGB_t){ rand() & 0xFF, rand() & 0xFF, rand() & 0xFF });
+}
+
+int8_t Bench_Init(NP32_Instance_t *handle, uint16_t led_count, uint8_t encoding, const NP32_Timing_t *timing)
+{
+    memset(handle, 0, sizeof(NP32_Instance_t));
+    handle->LED_Count = led_count;
+    handle->Encoding = encoding;
+    handle->Timing = timing;
+    handle->StartDMA_Call = Bench_StartDMA;
+    handle->StopDMA_Call = Bench_StopDMA;
+    Bench_Instance = handle;
+    if (NP32_Init(handle) != 0)
+    {
+        printf("  (init of %u LEDs failed)\n", led_count);
+        Bench_Mismatches++;
+        return -1;
+    }
+    Bench_Random_Fill(handle);
+    return 0;
+}
+
+uint32_t Bench_Check(uint32_t errors)
+{
+    Bench_Mismatches += errors;
+    return errors;
+}
+
+uint32_t Bench_Wire_Errors(const NP32_Sim_t *sim, NP32_Instance_t *handle, uint8_t check_len)
+{
+    NP32_RGB_t col;
+    uint32_t i, errors = 0;
+
+    if (check_len && sim->Frame_Len != (uint32_t) handle->LED_Count * 3)
+        errors++;
+    for (i = 0; i < handle->LED_Count && i * 3 + 2 < sim->Frame_Len; i++)
+    {
+        NP32_GetLED_RGB(handle, i, &col);
+        if (sim->Frame_GRB[i * 3] != col.G || sim->Frame_GRB[i * 3 + 1] != col.R || sim->Frame_GRB[i * 3 + 2] != col.B)
+            errors++;
+    }
+
+    return errors;
+}
+
+void Bench_Decode_DMA(NP32_Instance_t *handle, uint8_t *grb)
+{
+    NP32_Sim_Decoder_t dec;
+
+    NP32_Sim_Decoder_Reset(&dec, grb, handle->LED_Count * 3);
+    NP32_Sim_Decode(&dec, handle->_DMA_Buffer, (uint32_t) handle->LED_Count * NP32_WS2812_PERIODS_PER_LED);
+}
+
+int main(void)
+{
+    srand(1);
+
+    Bench_Core_Run();
+    Bench_Blend_Run();
+    Bench_Matrix_Run();
+    Bench_Parallel_Run();
+    Bench_Anim_Run();
+    Bench_Seq_Run();
+    Bench_Group_Run();
+
+    if (Bench_Mismatches != 0)
+    {
+        printf("\n%u mismatches.\n", Bench_Mismatches);
+        return 1;
+    }
+    printf("\nAll checks passed.\n");
+
+    return 0;
+}
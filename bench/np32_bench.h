@@ -0,0 +1,71 @@
+// np32_bench.h
+// Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+//
+// Shared fixture of the host benchmark suite. Each module of the library has its own benchmark file
+// (np32_bench_<module>.c), which times the module and checks its results. Every check adds its mismatches to
+// Bench_Mismatches, "make bench" fails if there are any.
+
+#if !defined(__NP32_BENCH_H)
+#define __NP32_BENCH_H
+
+#include "neopixel32.h"
+#include "neopixel32_sim.h"
+#include <stdint.h>
+
+#define BENCH_MIN_NS        200000000ULL
+
+#define BENCH_SIZE_COUNT    4U
+
+// Runs the given operation until the minimum benchmark time elapsed and returns the time per call in nanoseconds.
+#define BENCH_RUN(result_ns, op)                                                                                    \
+    do                                                                                                              \
+    {                                                                                                               \
+        uint64_t _t0 = Bench_Now(), _t;                                                                             \
+        uint32_t _n = 0;                                                                                            \
+        do                                                                                                          \
+        {                                                                                                           \
+            op;                                                                                                     \
+            _n++;                                                                                                   \
+        }                                                                                                           \
+        while ((_t = Bench_Now() - _t0) < BENCH_MIN_NS);                                                            \
+        (result_ns) = (double) _t / _n;                                                                             \
+    }                                                                                                               \
+    while (0)
+
+extern const uint16_t Bench_Sizes[BENCH_SIZE_COUNT];
+extern const NP32_Timing_t Bench_Fast_Timing;
+extern const char *Bench_Encoding_Names[];
+extern NP32_Instance_t *Bench_Instance;
+extern volatile uint32_t Bench_Sink;
+extern uint32_t Bench_Mismatches;
+
+uint64_t Bench_Now(void);
+
+// DMA start delegate, which completes the transfer right away. Used for measuring the CPU cost only.
+int8_t Bench_StartDMA(NP32_DMA_t *buf, uint16_t len);
+int8_t Bench_StopDMA(void);
+
+void Bench_Random_Fill(NP32_Instance_t *handle);
+
+// Initialises an instance with the immediate DMA delegates and random colours. A failed init counts as a mismatch.
+int8_t Bench_Init(NP32_Instance_t *handle, uint16_t led_count, uint8_t encoding, const NP32_Timing_t *timing);
+
+// Adds the mismatches of a check to Bench_Mismatches and returns them (for printing).
+uint32_t Bench_Check(uint32_t errors);
+
+// Counts the LEDs of the instance, whose colour on the simulated wire (GRB) differs from the colour buffer. With
+// check_len, a frame of the wrong length counts as a mismatch as well.
+uint32_t Bench_Wire_Errors(const NP32_Sim_t *sim, NP32_Instance_t *handle, uint8_t check_len);
+
+// Decodes the LED data of the DMA buffer of a PWM instance into grb (3 bytes per LED).
+void Bench_Decode_DMA(NP32_Instance_t *handle, uint8_t *grb);
+
+void Bench_Core_Run(void);
+void Bench_Blend_Run(void);
+void Bench_Matrix_Run(void);
+void Bench_Parallel_Run(void);
+void Bench_Anim_Run(void);
+void Bench_Seq_Run(void);
+void Bench_Group_Run(void);
+
+#endif // __NP32_BENCH_H
@@ -0,0 +1,179 @@
+// np32_bench_anim.c
+// Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+//
+// Benchmarks and checks of the animation module (neopixel32_anim.c).
+
+#include "np32_bench.h"
+#include "neopixel32_anim.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static uint32_t Bench_Time_us(void)
+{
+    return (uint32_t) (Bench_Now() / 1000ULL);
+}
+
+static void Bench_Effect_Rainbow(NP32_Effect_t *effect, NP32_RGB_t *leds, uint16_t count, uint32_t tick)
+{
+    NP32_HSV_t hsv = { 0, 255, 255 };
+    uint16_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        hsv.H = (uint16_t) ((tick * 16 + i * 6) % NP32_HSV8_HUE_STEPS);
+        NP32_HSV8_To_RGB(hsv, &leds[i]);
+    }
+}
+
+static void Bench_Effect_Dot(NP32_Effect_t *effect, NP32_RGB_t *leds, uint16_t count, uint32_t tick)
+{
+    leds[tick % count] = (NP32_RGB_t){ 255, 255, 255 };
+}
+
+static uint32_t Bench_Step_Time;
+
+static uint32_t Bench_Step_Time_us(void)
+{
+    return Bench_Step_Time;
+}
+
+// Counts the LEDs outside of the given span, which are not black, and the channel sums of the power limiter, which do
+// not match the colour buffer.
+static uint32_t Bench_Lit_Outside(const NP32_Instance_t *handle, uint16_t first, uint16_t count)
+{
+    const NP32_RGB_t *buf = handle->LED_Col_Buffer;
+    uint32_t errors = 0, sum[3] = { 0, 0, 0 };
+    uint16_t i;
+
+    for (i = 0; i < handle->LED_Count; i++)
+    {
+        if ((i < first || i >= first + count) && (buf[i].R | buf[i].G | buf[i].B) != 0)
+            errors++;
+        sum[0] += buf[i].R;
+        sum[1] += buf[i].G;
+        sum[2] += buf[i].B;
+    }
+
+    return errors + (sum[0] != handle->_Power_Sum[0]) + (sum[1] != handle->_Power_Sum[1]) +
+           (sum[2] != handle->_Power_Sum[2]);
+}
+
+// Steps an animation with effects on parts of the strip frame by frame: The LEDs outside of the spans have to stay
+// black (also the LEDs of a disabled effect and the random colours before the first frame), and the wire and the
+// channel sums of the power limiter have to match the colour buffer, although only the spans get re-encoded and
+// counted.
+static void Bench_Anim_Spans(void)
+{
+    NP32_Instance_t h;
+    NP32_Sim_t sim;
+    NP32_Anim_t anim;
+    NP32_Effect_t rainbow = { Bench_Effect_Rainbow, NULL, 8, 16, 1 };
+    NP32_Effect_t dot = { Bench_Effect_Dot, NULL, 40, 8, 1 };
+    uint32_t f, errors = 0;
+
+    memset(&h, 0, sizeof(NP32_Instance_t));
+    h.LED_Count = 64;
+    memset(&anim, 0, sizeof(NP32_Anim_t));
+    anim.Instance = &h;
+    anim.Tick_Period_us = 1000;
+    anim.GetTime_Call = Bench_Step_Time_us;
+    Bench_Step_Time = 0;
+    if (NP32_Sim_Attach(&sim, &h) != 0 || NP32_Init(&h) != 0 || NP32_Anim_Init(&anim) != 0)
+    {
+        printf("%8s  (init failed)\n", "spans");
+        Bench_Mismatches++;
+        return;
+    }
+    NP32_Anim_AddEffect(&anim, &rainbow);
+    NP32_Anim_AddEffect(&anim, &dot);
+    NP32_SetPowerLimit(&h, 100000, NP32_WS2812_CHANNEL_UA, NP32_WS2812_IDLE_UA);
+    Bench_Random_Fill(&h);
+    memcpy(NP32_GetBackBuffer(&h), h.LED_Col_Buffer, h.LED_Count * sizeof(NP32_RGB_t));
+    NP32_Update(&h);
+    NP32_Sim_WaitIdle(&sim);
+
+    for (f = 0; f < 8; f++)
+    {
+        // The rainbow gets disabled halfway through, its span has to turn black.
+        if (f == 4)
+            rainbow.Enabled = 0;
+        if (NP32_Anim_Run(&anim) != 1)
+            errors++;
+        NP32_Sim_WaitIdle(&sim);
+        errors += Bench_Wire_Errors(&sim, &h, 0);
+        errors += (f < 4) ? Bench_Lit_Outside(&h, 8, 40) : Bench_Lit_Outside(&h, 40, 8);
+        Bench_Step_Time += anim.Tick_Period_us;
+    }
+
+    printf("%8s %10u %10s %10u %10s %10s %10u\n", "spans", anim.Tick_Period_us, "-", anim.Tick, "-", "-",
+           Bench_Check(errors));
+
+    NP32_Sim_Detach(&sim);
+    NP32_DeInit(&h);
+}
+
+// Runs an animation on the simulated backend for the given time, sleeping between the frames.
+static void Bench_Anim(uint16_t led_count, uint32_t period_us, uint32_t run_ms)
+{
+    NP32_Instance_t h;
+    NP32_Sim_t sim;
+    NP32_Anim_t anim;
+    NP32_Effect_t rainbow = { Bench_Effect_Rainbow, NULL, 0, 0, 1 };
+    NP32_Effect_t dot = { Bench_Effect_Dot, NULL, 16, 32, 1 };
+    struct timespec ts;
+    uint64_t t0;
+    uint32_t wakeups = 0, errors = 0, wait;
+
+    memset(&h, 0, sizeof(NP32_Instance_t));
+    h.LED_Count = led_count;
+    memset(&anim, 0, sizeof(NP32_Anim_t));
+    anim.Instance = &h;
+    anim.Tick_Period_us = period_us;
+    anim.GetTime_Call = Bench_Time_us;
+    if (NP32_Sim_Attach(&sim, &h) != 0 || NP32_Init(&h) != 0 || NP32_Anim_Init(&anim) != 0)
+    {
+        printf("%8u %10u  (init failed)\n", led_count, period_us);
+        Bench_Mismatches++;
+        return;
+    }
+    NP32_Anim_AddEffect(&anim, &rainbow);
+    NP32_Anim_AddEffect(&anim, &dot);
+
+    t0 = Bench_Now();
+    while (Bench_Now() - t0 < run_ms * 1000000ULL)
+    {
+        NP32_Anim_Run(&anim);
+        wakeups++;
+
+        // Sleep until the next timestep, or shortly while the previous frame is pending.
+        wait = NP32_Anim_TimeToNext(&anim);
+        if (wait == 0)
+            wait = 200;
+        ts.tv_sec = 0;
+        ts.tv_nsec = (long) wait * 1000L;
+        nanosleep(&ts, NULL);
+    }
+    NP32_Sim_WaitIdle(&sim);
+
+    // The last frame on the wire has to be the last rendered one.
+    errors = Bench_Wire_Errors(&sim, &h, 0);
+
+    printf("%8u %10u %10.1f %10u %10u %10u %10u\n", led_count, period_us, anim.Frames_Rendered * 1000.0 / run_ms,
+           anim.Tick, anim.Ticks_Coalesced, wakeups, Bench_Check(errors));
+
+    NP32_Sim_Detach(&sim);
+    NP32_DeInit(&h);
+}
+
+void Bench_Anim_Run(void)
+{
+    printf("\n== Animation scheduler (simulated wire, 500ms) ==\n");
+    printf("%8s %10s %10s %10s %10s %10s %10s\n", "LEDs", "period us", "fps", "tick", "coalesced", "wakeups",
+           "mismatch");
+    Bench_Anim(256, 20000, 500);
+    Bench_Anim(256, 1000, 500);
+    Bench_Anim(1024, 10000, 500);
+    Bench_Anim_Spans();
+}
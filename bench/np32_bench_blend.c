@@ -0,0 +1,117 @@
+// np32_bench_blend.c
+// Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+//
+// Benchmarks and checks of the blend module (neopixel32_blend.c).
+
+#include "np32_bench.h"
+#include "neopixel32_blend.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Per-pixel loops as written by the application: Crossfade of two layers over the LEDs and a saturating additive
+// layer, all through the setters.
+static void Bench_Blend_App(NP32_Instance_t *handle, const NP32_RGB_t *l0, const NP32_RGB_t *l1, uint8_t a0, uint8_t a1)
+{
+    NP32_RGB_t c;
+    uint16_t i;
+
+    for (i = 0; i < handle->LED_Count; i++)
+    {
+        NP32_GetLED_RGB(handle, i, &c);
+        c.R = (uint8_t) ((c.R * (255 - a0) + l0[i].R * a0) / 255);
+        c.G = (uint8_t) ((c.G * (255 - a0) + l0[i].G * a0) / 255);
+        c.B = (uint8_t) ((c.B * (255 - a0) + l0[i].B * a0) / 255);
+        c.R = (uint8_t) ((c.R + l1[i].R * a1 / 255 > 255) ? 255 : c.R + l1[i].R * a1 / 255);
+        c.G = (uint8_t) ((c.G + l1[i].G * a1 / 255 > 255) ? 255 : c.G + l1[i].G * a1 / 255);
+        c.B = (uint8_t) ((c.B + l1[i].B * a1 / 255 > 255) ? 255 : c.B + l1[i].B * a1 / 255);
+        NP32_SetLED_RGB(handle, i, c);
+    }
+}
+
+// Reference of a single blended byte: Lerp (w = alpha + alpha / 128) followed by a saturating add of a scaled byte.
+static uint8_t Bench_Blend_Ref(uint8_t c, uint8_t l0, uint8_t l1, uint8_t a0, uint8_t a1)
+{
+    uint32_t w0 = a0 + (a0 >> 7), w1 = a1 + (a1 >> 7), v;
+
+    v = ((c * (256 - w0)) + (l0 * w0)) >> 8;
+    v += (l1 * w1) >> 8;
+    return (uint8_t) ((v > 255) ? 255 : v);
+}
+
+// Blending: Each operation of the blend module against the per-pixel loop of the application, on a rotated strip
+// (the spans wrap around the end of the colour buffer).
+static void Bench_Blend(uint16_t led_count)
+{
+    NP32_Instance_t h;
+    NP32_Layer_t layers[2];
+    NP32_RGB_t *l0, *l1, *base, *out;
+    double ns_app, ns_scale, ns_lerp, ns_add, ns_comp;
+    uint32_t i, errors = 0;
+    const uint8_t *c, *p0, *p1, *o;
+
+    if (Bench_Init(&h, led_count, NP32_ENCODING_PWM, NULL) != 0)
+        return;
+    NP32_RotateRight(&h, led_count / 3);
+    l0 = (NP32_RGB_t *) malloc((size_t) led_count * sizeof(NP32_RGB_t));
+    l1 = (NP32_RGB_t *) malloc((size_t) led_count * sizeof(NP32_RGB_t));
+    base = (NP32_RGB_t *) malloc((size_t) led_count * sizeof(NP32_RGB_t));
+    out = (NP32_RGB_t *) malloc((size_t) led_count * sizeof(NP32_RGB_t));
+    for (i = 0; i < led_count; i++)
+    {
+        l0[i] = (NP32_RGB_t){ rand() & 0xFF, rand() & 0xFF, rand() & 0xFF };
+        l1[i] = (NP32_RGB_t){ rand() & 0xFF, rand() & 0xFF, rand() & 0xFF };
+    }
+    layers[0] = (NP32_Layer_t){ l0, 77, NP32_BLEND_OVER };
+    layers[1] = (NP32_Layer_t){ l1, 200, NP32_BLEND_ADD };
+
+    BENCH_RUN(ns_app, Bench_Blend_App(&h, l0, l1, 77, 200));
+    BENCH_RUN(ns_scale, NP32_Blend_Scale(&h, 0, led_count, 250));
+    BENCH_RUN(ns_lerp, NP32_Blend_Lerp(&h, 0, l0, l1, led_count, 77));
+    BENCH_RUN(ns_add, NP32_Blend_Add(&h, 0, l1, led_count));
+    BENCH_RUN(ns_comp, NP32_Blend_Composite(&h, 0, layers, 2, led_count));
+
+    // Composite onto random colours and compare with the reference.
+    Bench_Random_Fill(&h);
+    for (i = 0; i < led_count; i++)
+        NP32_GetLED_RGB(&h, i, &base[i]);
+    NP32_Blend_Composite(&h, 0, layers, 2, led_count);
+    for (i = 0; i < led_count; i++)
+    {
+        NP32_GetLED_RGB(&h, i, &out[i]);
+        c = &base[i].R;
+        p0 = &l0[i].R;
+        p1 = &l1[i].R;
+        o = &out[i].R;
+        errors += (o[0] != Bench_Blend_Ref(c[0], p0[0], p1[0], 77, 200)) +
+                  (o[1] != Bench_Blend_Ref(c[1], p0[1], p1[1], 77, 200)) +
+                  (o[2] != Bench_Blend_Ref(c[2], p0[2], p1[2], 77, 200));
+    }
+
+    // Full and zero factors are exact, the buffer functions have to match the instance functions.
+    NP32_BlendBuf_Scale(out, base, led_count, 255);
+    errors += (memcmp(out, base, (size_t) led_count * sizeof(NP32_RGB_t)) != 0);
+    NP32_BlendBuf_Lerp(out, base, l0, led_count, 255);
+    errors += (memcmp(out, l0, (size_t) led_count * sizeof(NP32_RGB_t)) != 0);
+    NP32_BlendBuf_Lerp(out, base, l0, led_count, 0);
+    errors += (memcmp(out, base, (size_t) led_count * sizeof(NP32_RGB_t)) != 0);
+
+    printf("%8u %12.2f %12.2f %12.2f %12.2f %12.2f %10u\n", led_count, ns_app / led_count, ns_scale / led_count,
+           ns_lerp / led_count, ns_add / led_count, ns_comp / led_count, Bench_Check(errors));
+
+    free(l0);
+    free(l1);
+    free(base);
+    free(out);
+    NP32_DeInit(&h);
+}
+
+void Bench_Blend_Run(void)
+{
+    printf("\n== Blending (ns/LED, application loop = crossfade + additive layer per pixel) ==\n");
+    printf("%8s %12s %12s %12s %12s %12s %10s\n", "LEDs", "app loop", "scale", "lerp", "add", "composite",
+           "mismatch");
+    Bench_Blend(256);
+    Bench_Blend(1024);
+    Bench_Blend(2048);
+}
@@ -0,0 +1,768 @@
+// np32_bench_core.c
+// Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+//
+// Benchmarks and checks of the core module (neopixel32.c): Encoders, colour buffer operations, colour
+// correction, dithering, pixel formats, the simulated wire, prefix updates and the power limiter.
+
+#include "np32_bench.h"
+#include "neopixel32_blend.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+NP32_DEFINE_INSTANCE(Bench_Static_Strip, 256);
+
+static const char *Bench_Format_Names[] = { "GRB", "RGB", "BRG", "GRBW", "GRB16" };
+
+static void Bench_Encode(void)
+{
+    NP32_Instance_t h;
+    double ns_full, ns_one;
+    uint8_t s, e;
+
+    printf("\n== Encode (NP32_Update, DMA completes immediately) ==\n");
+    printf("%8s %8s %14s %14s %16s\n", "encoding", "LEDs", "full ns/LED", "full us/frame", "1 LED us/frame");
+    // Encoding 3: PWM with a runtime timing profile.
+    for (e = 0; e <= 3; e++)
+    {
+        for (s = 0; s < BENCH_SIZE_COUNT; s++)
+        {
+            if (Bench_Init(&h, Bench_Sizes[s], e % 3, (e == 3) ? &Bench_Fast_Timing : NULL) != 0)
+                continue;
+            BENCH_RUN(ns_full, NP32_MarkDirty(&h, 0, h.LED_Count - 1); NP32_Update(&h));
+            BENCH_RUN(ns_one, NP32_SetLED_RGB(&h, _n % h.LED_Count, NP32_COL_BLACK); NP32_Update(&h));
+            printf("%8s %8u %14.2f %14.2f %16.2f\n", Bench_Encoding_Names[e], h.LED_Count, ns_full / h.LED_Count,
+                   ns_full / 1000.0, ns_one / 1000.0);
+            NP32_DeInit(&h);
+        }
+    }
+}
+
+// Reference encoder: The per-bit encoder the table encoder replaced, resolving each of the 24 bits of an LED with
+// NP32_RESOLVE_BIT_TIME (default PWM timing, GRB). Appends the reset periods like NP32_Update.
+static void Bench_Encode_Ref(const NP32_Instance_t *handle, NP32_DMA_t *dst)
+{
+    NP32_RGB_t curr_col;
+    uint16_t i;
+    uint8_t b;
+
+    for (i = 0; i < handle->LED_Count; i++)
+    {
+        curr_col = handle->LED_Col_Buffer[i];
+
+        // Bits G7 to G0.
+        b = 8;
+        do
+        {
+            *dst++ = NP32_RESOLVE_BIT_TIME(curr_col.G, --b);
+        }
+        while (b > 0);
+        // Bits R7 to R0.
+        b = 8;
+        do
+        {
+            *dst++ = NP32_RESOLVE_BIT_TIME(curr_col.R, --b);
+        }
+        while (b > 0);
+        // Bits B7 to B0.
+        b = 8;
+        do
+        {
+            *dst++ = NP32_RESOLVE_BIT_TIME(curr_col.B, --b);
+        }
+        while (b > 0);
+    }
+    for (i = 0; i < NP32_WS2812_ZERO_PERIODS; i++)
+        *dst++ = 0x00;
+}
+
+static void Bench_Encode_Table(void)
+{
+    NP32_Instance_t h;
+    NP32_DMA_t *ref;
+    double ns_ref, ns_lut;
+    uint32_t entries, errors;
+    uint8_t s;
+
+    printf("\n== Bit encoder (PWM, full frame: per-bit NP32_RESOLVE_BIT_TIME reference vs. table) ==\n");
+    printf("%8s %14s %14s %10s %10s\n", "LEDs", "per-bit ns/LED", "table ns/LED", "speedup", "mismatch");
+    for (s = 0; s < BENCH_SIZE_COUNT; s++)
+    {
+        if (Bench_Init(&h, Bench_Sizes[s], NP32_ENCODING_PWM, NULL) != 0)
+            continue;
+        entries = ((uint32_t) h.LED_Count * NP32_WS2812_PERIODS_PER_LED) + NP32_WS2812_ZERO_PERIODS;
+        ref = (NP32_DMA_t *) malloc(entries * sizeof(NP32_DMA_t));
+
+        BENCH_RUN(ns_ref, Bench_Encode_Ref(&h, ref); Bench_Sink += ref[_n % entries]);
+        BENCH_RUN(ns_lut, NP32_MarkDirty(&h, 0, h.LED_Count - 1); NP32_Update(&h));
+        errors = (memcmp(ref, h._DMA_Buffer, entries * sizeof(NP32_DMA_t)) != 0);
+
+        printf("%8u %14.2f %14.2f %9.2fx %10u\n", h.LED_Count, ns_ref / h.LED_Count, ns_lut / h.LED_Count,
+               ns_ref / ns_lut, Bench_Check(errors));
+        free(ref);
+        NP32_DeInit(&h);
+    }
+}
+
+static void Bench_Buffer_Ops(void)
+{
+    NP32_Instance_t h;
+    double ns_fill, ns_span, ns_shift, ns_rot, ns_enc;
+    uint8_t s;
+
+    printf("\n== Colour buffer operations (ns/LED, rotate and shift in ns/call) ==\n");
+    printf("%8s %12s %12s %12s %12s %16s\n", "LEDs", "SetAll", "SetSpan", "ShiftLeft 1", "RotateLeft 1",
+           "Rotate+Update/LED");
+    for (s = 0; s < BENCH_SIZE_COUNT; s++)
+    {
+        if (Bench_Init(&h, Bench_Sizes[s], NP32_ENCODING_PWM, NULL) != 0)
+            continue;
+        BENCH_RUN(ns_fill, NP32_SetAllLEDs_RGB(&h, (NP32_RGB_t){ _n, 1, 2 }));
+        BENCH_RUN(ns_span, NP32_SetLEDSpan_RGB(&h, 1, h.LED_Count - 2, (NP32_RGB_t){ _n, 1, 2 }));
+        BENCH_RUN(ns_shift, NP32_ShiftLeft(&h, 1));
+        BENCH_RUN(ns_rot, NP32_RotateLeft(&h, 1));
+        BENCH_RUN(ns_enc, NP32_RotateLeft(&h, 1); NP32_Update(&h));
+        printf("%8u %12.3f %12.3f %12.3f %12.3f %16.3f\n", h.LED_Count, ns_fill / h.LED_Count, ns_span / h.LED_Count,
+               ns_shift, ns_rot, ns_enc / h.LED_Count);
+        NP32_DeInit(&h);
+    }
+}
+
+static void Bench_Bulk(void)
+{
+    NP32_Instance_t h;
+    NP32_RGB_t *frame, col;
+    uint8_t *grb;
+    double ns_px, ns_rgb, ns_grb, ns_att, ns_commit;
+    uint32_t errors = 0;
+    uint16_t i;
+
+    printf("\n== Bulk frame writes (1024 LEDs, ns/LED, attach and commit in ns/call) ==\n");
+    if (Bench_Init(&h, 1024, NP32_ENCODING_PWM, NULL) != 0 || NP32_EnableDoubleBuffer(&h, NULL) != 0)
+        return;
+    frame = (NP32_RGB_t *) malloc(h.LED_Count * sizeof(NP32_RGB_t));
+    grb = (uint8_t *) malloc(h.LED_Count * 3);
+    for (i = 0; i < h.LED_Count * 3; i++)
+        grb[i] = rand() & 0xFF;
+    memcpy(frame, grb, h.LED_Count * 3);
+
+    BENCH_RUN(ns_px, for (i = 0; i < h.LED_Count; i++) NP32_SetLED_RGB(&h, i, frame[i]));
+    BENCH_RUN(ns_rgb, NP32_SetLEDs_RGB(&h, 0, frame, h.LED_Count));
+    BENCH_RUN(ns_grb, NP32_SetLEDs_GRB(&h, 0, grb, h.LED_Count));
+    BENCH_RUN(ns_att, NP32_AttachFrame(&h, frame));
+    BENCH_RUN(ns_commit, NP32_Commit(&h));
+
+    // Check a bulk write into a rotated buffer.
+    NP32_RotateLeft(&h, 300);
+    NP32_SetLEDs_GRB(&h, 10, grb, h.LED_Count - 10);
+    for (i = 10; i < h.LED_Count; i++)
+    {
+        NP32_GetLED_RGB(&h, i, &col);
+        if (col.G != grb[(i - 10) * 3] || col.R != grb[(i - 10) * 3 + 1] || col.B != grb[(i - 10) * 3 + 2])
+            errors++;
+    }
+
+    printf("%14s %14s %14s %12s %12s %10s\n", "SetLED_RGB", "SetLEDs_RGB", "SetLEDs_GRB", "AttachFrame", "Commit",
+           "mismatch");
+    printf("%14.3f %14.3f %14.3f %12.2f %12.2f %10u\n", ns_px / h.LED_Count, ns_rgb / h.LED_Count,
+           ns_grb / h.LED_Count, ns_att, ns_commit, Bench_Check(errors));
+
+    NP32_DeInit(&h);
+    free(frame);
+    free(grb);
+}
+
+// Scales a colour byte by a factor of 0 to 255 (rounded).
+static uint8_t Bench_Scale(uint8_t val, uint8_t scale)
+{
+    return (uint8_t) (((uint32_t) val * scale + 127) / 255);
+}
+
+static void Bench_Brightness(void)
+{
+    NP32_Instance_t h;
+    NP32_RGB_t *copy, col;
+    uint8_t *grb;
+    double ns_lut, ns_app;
+    uint32_t errors = 0;
+    uint16_t i;
+
+    printf("\n== Brightness fade (1024 LEDs, full frame per step) ==\n");
+    if (Bench_Init(&h, 1024, NP32_ENCODING_PWM, NULL) != 0)
+        return;
+    copy = (NP32_RGB_t *) malloc(h.LED_Count * sizeof(NP32_RGB_t));
+    grb = (uint8_t *) malloc(h.LED_Count * 3);
+    memcpy(copy, h.LED_Col_Buffer, h.LED_Count * sizeof(NP32_RGB_t));
+
+    // Fused: Only the correction table gets rebuilt, the encoder applies it.
+    BENCH_RUN(ns_lut, NP32_SetBrightness(&h, _n); NP32_Update(&h));
+
+    // Application side: Scale a copy of the frame into the colour buffer at every step.
+    BENCH_RUN(ns_app, for (i = 0; i < h.LED_Count; i++)
+                      {
+                          h.LED_Col_Buffer[i].R = (copy[i].R * (_n & 0xFF)) / 255;
+                          h.LED_Col_Buffer[i].G = (copy[i].G * (_n & 0xFF)) / 255;
+                          h.LED_Col_Buffer[i].B = (copy[i].B * (_n & 0xFF)) / 255;
+                      }
+                      NP32_MarkDirty(&h, 0, h.LED_Count - 1); NP32_Update(&h));
+
+    // Check the encoded frame with gamma, white balance and brightness set.
+    memcpy(h.LED_Col_Buffer, copy, h.LED_Count * sizeof(NP32_RGB_t));
+    NP32_MarkDirty(&h, 0, h.LED_Count - 1);
+    NP32_SetGamma(&h, NP32_Gamma_2_2);
+    NP32_SetWhiteBalance(&h, (NP32_RGB_t){ 255, 200, 180 });
+    NP32_SetBrightness(&h, 128);
+    NP32_Update(&h);
+    Bench_Decode_DMA(&h, grb);
+    for (i = 0; i < h.LED_Count; i++)
+    {
+        col = h.LED_Col_Buffer[i];
+        if (grb[i * 3] != Bench_Scale(Bench_Scale(NP32_Gamma_2_2[col.G], 200), 128) ||
+            grb[i * 3 + 1] != Bench_Scale(NP32_Gamma_2_2[col.R], 128) ||
+            grb[i * 3 + 2] != Bench_Scale(Bench_Scale(NP32_Gamma_2_2[col.B], 180), 128))
+            errors++;
+    }
+
+    printf("%24s %12s %10s\n", "SetBrightness+Update", "app scaling", "mismatch");
+    printf("%21.2f us %9.2f us %10u\n", ns_lut / 1000.0, ns_app / 1000.0, Bench_Check(errors));
+
+    free(copy);
+    free(grb);
+    NP32_DeInit(&h);
+}
+
+static void Bench_Dither(void)
+{
+    NP32_Instance_t h;
+    NP32_RGB16_t *hp;
+    uint32_t *sum;
+    uint8_t *grb;
+    double ns_plain, ns_dither;
+    uint32_t errors = 0;
+    uint16_t i, k;
+
+    printf("\n== Temporal dithering (1024 LEDs, full frame per update) ==\n");
+    if (Bench_Init(&h, 1024, NP32_ENCODING_PWM, NULL) != 0)
+        return;
+    sum = (uint32_t *) calloc(h.LED_Count * 3, sizeof(uint32_t));
+    grb = (uint8_t *) malloc(h.LED_Count * 3);
+
+    BENCH_RUN(ns_plain, NP32_MarkDirty(&h, 0, h.LED_Count - 1); NP32_Update(&h));
+    if (NP32_EnableDither(&h, NULL, NULL) != 0)
+        return;
+    BENCH_RUN(ns_dither, NP32_Update(&h));
+
+    // Over 256 frames, the sent values have to add up to the high-precision values.
+    hp = NP32_GetDitherBuffer(&h);
+    for (i = 0; i < h.LED_Count; i++)
+        hp[i] = (NP32_RGB16_t){ rand() % 0xFF01, rand() % 0x0400, rand() % 0xFF01 };
+    NP32_EnableDither(&h, hp, (uint8_t *) (hp + h.LED_Count));
+    for (k = 0; k < 256; k++)
+    {
+        NP32_Update(&h);
+        Bench_Decode_DMA(&h, grb);
+        for (i = 0; i < h.LED_Count * 3; i++)
+            sum[i] += grb[i];
+    }
+    for (i = 0; i < h.LED_Count; i++)
+    {
+        if (sum[i * 3] != hp[i].G || sum[i * 3 + 1] != hp[i].R || sum[i * 3 + 2] != hp[i].B)
+            errors++;
+    }
+
+    printf("%14s %14s %10s\n", "8-bit ns/LED", "dither ns/LED", "mismatch");
+    printf("%14.2f %14.2f %10u\n", ns_plain / h.LED_Count, ns_dither / h.LED_Count, Bench_Check(errors));
+
+    free(sum);
+    free(grb);
+    NP32_DeInit(&h);
+}
+
+static void Bench_HSV(void)
+{
+    NP32_Instance_t h;
+    NP32_HSV_t hsv[1024];
+    NP32_RGB_t rgb, rgb_arr[1024];
+    double ns, ns_fast, ns_arr, ns_loop, ns_rainbow, ns_grad;
+    uint16_t i;
+
+    printf("\n== Colour conversion ==\n");
+    // Batches of 1024 calls, so the clock reads do not dominate.
+    BENCH_RUN(ns, for (i = 0; i < 1024; i++)
+                  {
+                      NP32_HSV_To_RGB((NP32_HSV_t){ (i + _n) % 360, 100 - (i % 50), 100 }, &rgb);
+                      Bench_Sink += rgb.G;
+                  });
+    ns /= 1024;
+    printf("NP32_HSV_To_RGB:        %8.2f ns/call, %8.2f Mconv/s\n", ns, 1000.0 / ns);
+    BENCH_RUN(ns_fast, for (i = 0; i < 1024; i++)
+                       {
+                           NP32_HSV8_To_RGB((NP32_HSV_t){ (i + _n) % 1536, 255 - (i % 128), 255 }, &rgb);
+                           Bench_Sink += rgb.G;
+                       });
+    ns_fast /= 1024;
+    printf("NP32_HSV8_To_RGB:       %8.2f ns/call, %8.2f Mconv/s (%.2fx)\n", ns_fast, 1000.0 / ns_fast, ns / ns_fast);
+
+    for (i = 0; i < 1024; i++)
+        hsv[i] = (NP32_HSV_t){ (i * 3) % 1536, 255 - (i % 128), 200 };
+    BENCH_RUN(ns_arr, NP32_HSV8_To_RGB_Array(hsv, rgb_arr, 1024); Bench_Sink += rgb_arr[_n % 1024].R);
+    printf("NP32_HSV8_To_RGB_Array: %8.2f ns/LED\n", ns_arr / 1024);
+
+    // Span fills of 1024 LEDs: Per-LED conversion with the legacy function vs. the rainbow and gradient fills.
+    if (Bench_Init(&h, 1024, NP32_ENCODING_PWM, NULL) != 0)
+        return;
+    BENCH_RUN(ns_loop, for (i = 0; i < h.LED_Count; i++)
+                           NP32_SetLED_HSV(&h, i, (NP32_HSV_t){ ((i * 360U) / h.LED_Count + _n) % 360, 100, 100 }));
+    BENCH_RUN(ns_rainbow, NP32_SetLEDSpan_Rainbow(&h, 0, h.LED_Count - 1, _n % 1536, NP32_HSV8_HUE_STEPS, 255, 255));
+    BENCH_RUN(ns_grad, NP32_SetLEDSpan_Gradient(&h, 0, h.LED_Count - 1, (NP32_HSV_t){ _n % 1536, 255, 64 },
+                                                (NP32_HSV_t){ 1000, 128, 255 }));
+    printf("%8s %18s %18s %18s\n", "LEDs", "SetLED_HSV loop", "SetLEDSpan_Rainbow", "SetLEDSpan_Gradient");
+    printf("%8u %15.2f ns %15.2f ns %16.2f ns  (per LED)\n", h.LED_Count, ns_loop / h.LED_Count,
+           ns_rainbow / h.LED_Count, ns_grad / h.LED_Count);
+    NP32_DeInit(&h);
+}
+
+static void Bench_Wire(uint8_t encoding, uint16_t led_count, uint16_t chunk)
+{
+    NP32_Instance_t h;
+    NP32_Sim_t sim;
+    uint64_t t;
+    uint32_t errors = 0;
+
+    memset(&h, 0, sizeof(NP32_Instance_t));
+    h.LED_Count = led_count;
+    h.Stream_Chunk_LEDs = chunk;
+    h.Encoding = encoding % 3;
+    if (encoding == 3)
+        h.Timing = &Bench_Fast_Timing;
+    if (NP32_Sim_Attach(&sim, &h) != 0 || NP32_Init(&h) != 0)
+    {
+        printf("%8s %8u %8u  (init failed)\n", Bench_Encoding_Names[encoding], led_count, chunk);
+        Bench_Mismatches++;
+        return;
+    }
+    if (h.Timing != NULL)
+        sim.Period_ns = 1000;
+    Bench_Random_Fill(&h);
+
+    t = Bench_Now();
+    NP32_Update(&h);
+    NP32_Sim_WaitIdle(&sim);
+    t = Bench_Now() - t;
+
+    // Compare the decoded wire data with the colour buffer.
+    errors = Bench_Wire_Errors(&sim, &h, 1);
+
+    printf("%8s %8u %8u %12.2f %14.2f %10u %10u %10u\n", Bench_Encoding_Names[encoding], led_count, chunk, t / 1000000.0,
+           sim.Max_Callback_ns / 1000.0, sim.Underruns, h.Stream_Underrun_Count, Bench_Check(errors));
+
+    NP32_Sim_Detach(&sim);
+    NP32_DeInit(&h);
+}
+
+// Changes LEDs within the first touched LEDs of the strip (and every 8th frame one LED anywhere) in a loop, with and
+// without the prefix update mode. The chain keeps the colours of the LEDs not transmitted, as the decoder of the
+// simulated channel does. After each frame, the decoded chain has to match the colour buffer.
+static void Bench_Prefix(uint8_t encoding, uint16_t led_count, uint16_t touched, uint32_t frames)
+{
+    NP32_Instance_t h;
+    NP32_Sim_t sim;
+    double fps[2];
+    uint64_t t;
+    uint32_t f, errors = 0;
+    uint8_t mode;
+
+    for (mode = 0; mode < 2; mode++)
+    {
+        memset(&h, 0, sizeof(NP32_Instance_t));
+        h.LED_Count = led_count;
+        h.Encoding = encoding;
+        if (NP32_Sim_Attach(&sim, &h) != 0 || NP32_Init(&h) != 0)
+        {
+            printf("%8s %8u  (init failed)\n", Bench_Encoding_Names[encoding], led_count);
+            Bench_Mismatches++;
+            return;
+        }
+        Bench_Random_Fill(&h);
+        NP32_Update(&h);
+        NP32_Sim_WaitIdle(&sim);
+        h.Prefix_Update_Flag = mode;
+
+        t = Bench_Now();
+        for (f = 0; f < frames; f++)
+        {
+            NP32_SetLED_RGB(&h, rand() % touched, (NP32_RGB_t){ rand() & 0xFF, rand() & 0xFF, rand() & 0xFF });
+            if ((f % 8) == 7)
+                NP32_SetLED_RGB(&h, rand() % led_count, (NP32_RGB_t){ rand() & 0xFF, 0, rand() & 0xFF });
+            NP32_Update(&h);
+            NP32_Sim_WaitIdle(&sim);
+            errors += Bench_Wire_Errors(&sim, &h, 0);
+        }
+        fps[mode] = frames * 1e9 / (Bench_Now() - t);
+
+        NP32_Sim_Detach(&sim);
+        NP32_DeInit(&h);
+    }
+
+    printf("%8s %8u %8u %12.1f %12.1f %10u\n", Bench_Encoding_Names[encoding], led_count, touched, fps[0], fps[1],
+           Bench_Check(errors));
+}
+
+// Reference of the bytes sent to an LED in the given pixel format.
+static uint8_t Bench_Format_Ref(uint8_t format, NP32_RGB_t c, const NP32_RGB16_t *wide, uint8_t *out)
+{
+    uint8_t w;
+
+    switch (format)
+    {
+        case NP32_FORMAT_RGB:
+            out[0] = c.R; out[1] = c.G; out[2] = c.B;
+            return 3;
+        case NP32_FORMAT_BRG:
+            out[0] = c.B; out[1] = c.R; out[2] = c.G;
+            return 3;
+        case NP32_FORMAT_GRBW:
+            w = (c.R < c.G) ? c.R : c.G;
+            w = (c.B < w) ? c.B : w;
+            out[0] = c.G - w; out[1] = c.R - w; out[2] = c.B - w; out[3] = w;
+            return 4;
+        case NP32_FORMAT_GRB16:
+            // The high-precision colours get sent as they are (brightness and white balance at full scale).
+            if (wide != NULL)
+            {
+                out[0] = wide->G >> 8; out[1] = (uint8_t) wide->G; out[2] = wide->R >> 8; out[3] = (uint8_t) wide->R;
+                out[4] = wide->B >> 8; out[5] = (uint8_t) wide->B;
+                return 6;
+            }
+            out[0] = out[1] = c.G; out[2] = out[3] = c.R; out[4] = out[5] = c.B;
+            return 6;
+        default:
+            out[0] = c.G; out[1] = c.R; out[2] = c.B;
+            return 3;
+    }
+}
+
+// Checks the sent frame of an instance against the reference byte order of its pixel format.
+static uint32_t Bench_Format_Errors(const NP32_Sim_t *sim, NP32_Instance_t *handle)
+{
+    const NP32_RGB16_t *wide = NP32_GetDitherBuffer(handle);
+    uint8_t ref[6];
+    uint32_t i, j, n, pos = 0, errors = 0;
+
+    if (sim->Frame_Len != handle->LED_Count * NP32_FORMAT_BYTES(handle->Format))
+        errors++;
+    for (i = 0; i < handle->LED_Count; i++)
+    {
+        n = Bench_Format_Ref(handle->Format, handle->LED_Col_Buffer[i], (wide != NULL) ? &wide[i] : NULL, ref);
+        for (j = 0; j < n; j++, pos++)
+        {
+            if (pos >= sim->Frame_Len || sim->Frame_GRB[pos] != ref[j])
+                errors++;
+        }
+    }
+
+    return errors;
+}
+
+// Wire transfer of each pixel format, checked against the reference byte order. The 16-bit format also gets checked
+// with random high-precision colours (mostly not multiples of 257).
+static void Bench_Format(uint8_t format, uint8_t encoding, uint16_t led_count, uint16_t chunk)
+{
+    NP32_Instance_t h;
+    NP32_Sim_t sim;
+    uint32_t errors = 0;
+    uint16_t i;
+
+    memset(&h, 0, sizeof(NP32_Instance_t));
+    h.LED_Count = led_count;
+    h.Stream_Chunk_LEDs = chunk;
+    h.Encoding = encoding % 3;
+    h.Format = format;
+    if (encoding == 3)
+        h.Timing = &Bench_Fast_Timing;
+    if (NP32_Sim_Attach(&sim, &h) != 0 || NP32_Init(&h) != 0)
+    {
+        printf("%8s %8s %8u %8u  (init failed)\n", Bench_Format_Names[format], Bench_Encoding_Names[encoding],
+               led_count, chunk);
+        Bench_Mismatches++;
+        return;
+    }
+    if (h.Timing != NULL)
+        sim.Period_ns = 1000;
+    Bench_Random_Fill(&h);
+    NP32_Update(&h);
+    NP32_Sim_WaitIdle(&sim);
+    errors = Bench_Format_Errors(&sim, &h);
+
+    if (format == NP32_FORMAT_GRB16)
+    {
+        if (NP32_EnableDither(&h, NULL, NULL) != 0)
+            errors++;
+        for (i = 0; i < led_count; i++)
+            NP32_SetLED_RGB16(&h, i, (NP32_RGB16_t){ rand() & 0xFFFF, rand() & 0xFFFF, rand() & 0xFFFF });
+        NP32_Update(&h);
+        NP32_Sim_WaitIdle(&sim);
+        errors += Bench_Format_Errors(&sim, &h);
+    }
+
+    printf("%8s %8s %8u %8u %10u %10u\n", Bench_Format_Names[format], Bench_Encoding_Names[encoding], led_count, chunk,
+           NP32_GetDMABufEntries(&h), Bench_Check(errors));
+
+    NP32_Sim_Detach(&sim);
+    NP32_DeInit(&h);
+}
+
+// Wire transfer of a heap-free instance (static buffers).
+static void Bench_Static(void)
+{
+    NP32_Sim_t sim;
+    uint32_t errors = 0;
+
+    if (NP32_Sim_Attach(&sim, &Bench_Static_Strip) != 0 || NP32_INIT_STATIC(Bench_Static_Strip) != 0)
+    {
+        printf("%8s %8u %8u  (init failed)\n", "static", 256, 0);
+        Bench_Mismatches++;
+        return;
+    }
+    Bench_Random_Fill(&Bench_Static_Strip);
+    NP32_RotateRight(&Bench_Static_Strip, 77);
+    NP32_Update(&Bench_Static_Strip);
+    NP32_Sim_WaitIdle(&sim);
+
+    errors = Bench_Wire_Errors(&sim, &Bench_Static_Strip, 1);
+    printf("%8s %8u %8u %12s %14.2f %10u %10u %10u\n", "static", 256, 0, "-", sim.Max_Callback_ns / 1000.0,
+           sim.Underruns, Bench_Static_Strip.Stream_Underrun_Count, Bench_Check(errors));
+
+    NP32_Sim_Detach(&sim);
+    NP32_DeInit(&Bench_Static_Strip);
+}
+
+// Counts the channel values of the colour buffer and the current of the sent frame (decoded from the DMA buffer).
+static uint32_t Bench_Power_Check(NP32_Instance_t *handle, uint8_t *grb, uint64_t *sent_ua)
+{
+    uint32_t sum[3] = { 0, 0, 0 }, i, total = 0;
+
+    for (i = 0; i < handle->LED_Count; i++)
+    {
+        sum[0] += handle->LED_Col_Buffer[i].R;
+        sum[1] += handle->LED_Col_Buffer[i].G;
+        sum[2] += handle->LED_Col_Buffer[i].B;
+    }
+    Bench_Decode_DMA(handle, grb);
+    for (i = 0; i < handle->LED_Count * 3U; i++)
+        total += grb[i];
+    *sent_ua = (((uint64_t) total * NP32_WS2812_CHANNEL_UA) / 255U) +
+               ((uint64_t) handle->LED_Count * NP32_WS2812_IDLE_UA);
+
+    return (sum[0] != handle->_Power_Sum[0]) + (sum[1] != handle->_Power_Sum[1]) + (sum[2] != handle->_Power_Sum[2]);
+}
+
+// Application side: Scan the colour buffer for the current and set the brightness accordingly.
+static void Bench_Power_App(NP32_Instance_t *handle, uint32_t budget_mA)
+{
+    uint64_t sum = 0, ua, idle = (uint64_t) handle->LED_Count * NP32_WS2812_IDLE_UA;
+    uint8_t b = 255;
+    uint16_t i;
+
+    for (i = 0; i < handle->LED_Count; i++)
+        sum += (uint32_t) handle->LED_Col_Buffer[i].R + handle->LED_Col_Buffer[i].G + handle->LED_Col_Buffer[i].B;
+    ua = (sum * NP32_WS2812_CHANNEL_UA) / 255U;
+    if (ua + idle > (uint64_t) budget_mA * 1000U)
+        b = (uint8_t) ((((uint64_t) budget_mA * 1000U - idle) * 255U) / ua);
+    if (b != handle->_Brightness)
+        NP32_SetBrightness(handle, b);
+}
+
+static void Bench_Power(uint16_t led_count, uint32_t budget_mA, uint16_t touched)
+{
+    NP32_Instance_t h;
+    NP32_RGB_t *src, *frame_buf;
+    uint8_t *grb;
+    uint64_t sent_ua;
+    double ns_app, ns_lim;
+    uint32_t frame, errors = 0, over = 0, est;
+    uint16_t i, k;
+
+    if (Bench_Init(&h, led_count, NP32_ENCODING_PWM, NULL) != 0)
+        return;
+    src = (NP32_RGB_t *) malloc((size_t) led_count * sizeof(NP32_RGB_t));
+    grb = (uint8_t *) malloc((size_t) led_count * 3);
+    for (i = 0; i < led_count; i++)
+        src[i] = (NP32_RGB_t){ rand() & 0xFF, rand() & 0xFF, rand() & 0xFF };
+
+    // Frames changing a few LEDs: Application scan and brightness vs. the limiter.
+    BENCH_RUN(ns_app, for (k = 0; k < touched; k++)
+                          NP32_SetLED_RGB(&h, rand() % led_count, src[rand() % led_count]);
+                      Bench_Power_App(&h, budget_mA); NP32_Update(&h));
+    NP32_SetBrightness(&h, 255);
+    NP32_SetPowerLimit(&h, budget_mA, NP32_WS2812_CHANNEL_UA, NP32_WS2812_IDLE_UA);
+    BENCH_RUN(ns_lim, for (k = 0; k < touched; k++)
+                          NP32_SetLED_RGB(&h, rand() % led_count, src[rand() % led_count]);
+                      NP32_Update(&h));
+    est = NP32_GetPowerEstimate(&h);
+
+    // Mixed operations: The running sums have to match a full count and the sent frame has to stay within the budget.
+    for (frame = 0; frame < 64; frame++)
+    {
+        i = rand() % led_count;
+        k = 1 + (rand() % (led_count - i));
+        switch (frame % 8)
+        {
+            case 0: NP32_SetLEDSpan_RGB(&h, i, i + k - 1, src[frame]); break;
+            case 1: NP32_SetLEDSpan_Rainbow(&h, i, i + k - 1, frame * 40, 1536, 255, 255); break;
+            case 2: NP32_ShiftLeft(&h, k); break;
+            case 3: NP32_SetLEDs_RGB(&h, i, src, k); break;
+            case 4: NP32_RotateRight(&h, k); NP32_ShiftRight(&h, k / 2); break;
+            case 5: NP32_Blend_Scale(&h, i, k, 128); break;
+            case 6: NP32_SetLEDSpan_Gradient(&h, i, i + k - 1, (NP32_HSV_t){ 0, 255, 255 },
+                                             (NP32_HSV_t){ 1000, 100, 50 }); break;
+            default: NP32_SetAllLEDs_RGB(&h, src[frame]); NP32_SetLED_RGB(&h, i, NP32_COL_BLACK); break;
+        }
+        NP32_Update(&h);
+        errors += Bench_Power_Check(&h, grb, &sent_ua);
+        over += (sent_ua > (uint64_t) budget_mA * 1000U);
+    }
+
+    // Changes outside of the setters have to be counted by the call reporting them already, the update (which may run
+    // in the DMA-complete interrupt) does not count.
+    frame_buf = (NP32_RGB_t *) malloc((size_t) led_count * sizeof(NP32_RGB_t));
+    NP32_EnableDoubleBuffer(&h, NULL);
+    for (frame = 0; frame < 24; frame++)
+    {
+        i = rand() % led_count;
+        switch (frame % 3)
+        {
+            case 0:
+                for (k = 0; k < led_count; k++)
+                    NP32_GetBackBuffer(&h)[k] = src[rand() % led_count];
+                NP32_Commit(&h);
+                break;
+            case 1:
+                h.LED_Col_Buffer[i] = src[frame];
+                NP32_MarkDirty(&h, i, i);
+                break;
+            default:
+                for (k = 0; k < led_count; k++)
+                    frame_buf[k] = src[rand() % led_count];
+                NP32_AttachFrame(&h, (frame & 1) ? frame_buf : NP32_GetBackBuffer(&h));
+                break;
+        }
+        errors += Bench_Power_Check(&h, grb, &sent_ua);
+        NP32_Update(&h);
+        errors += Bench_Power_Check(&h, grb, &sent_ua);
+        over += (sent_ua > (uint64_t) budget_mA * 1000U);
+    }
+
+    printf("%8u %10u %10u %8u %14.2f %14.2f %8u %10u\n", led_count, budget_mA, est, NP32_GetPowerScale(&h),
+           ns_app / 1000.0, ns_lim / 1000.0, Bench_Check(over), Bench_Check(errors));
+
+    NP32_DeInit(&h);
+    free(frame_buf);
+    free(src);
+    free(grb);
+}
+
+#if defined(NP32_CFG_STATS)
+// Hot-path statistics of a strip updated in a loop, alternating blocking and non-blocking updates.
+static void Bench_Stats(uint16_t led_count, uint16_t chunk)
+{
+    NP32_Instance_t h;
+    NP32_Sim_t sim;
+    NP32_Stats_t st;
+    uint32_t k;
+
+    memset(&h, 0, sizeof(NP32_Instance_t));
+    h.LED_Count = led_count;
+    h.Stream_Chunk_LEDs = chunk;
+    if (NP32_Sim_Attach(&sim, &h) != 0 || NP32_Init(&h) != 0)
+    {
+        printf("%8u %8u  (init failed)\n", led_count, chunk);
+        Bench_Mismatches++;
+        return;
+    }
+
+    for (k = 0; k < 20; k++)
+    {
+        Bench_Random_Fill(&h);
+        if (k & 0x01)
+        {
+            NP32_UpdateAsync(&h);
+            NP32_UpdateAsync(&h);
+        }
+        else
+        {
+            NP32_Update(&h);
+        }
+    }
+    NP32_Sim_WaitIdle(&sim);
+    NP32_GetStats(&h, &st);
+
+    printf("%8u %8u %8u %8u %12.2f %12.2f %12.2f %12.2f %10.1f\n", led_count, chunk, st.Frames_Sent,
+           st.Frames_Skipped, st.Encode_Time_Max / 1000.0, st.Wait_Time_Max / 1000.0, st.DMA_Time_Last / 1000.0,
+           st.Frame_Interval_Last / 1000.0, (st.Frame_Interval_Last != 0) ? 1e9 / st.Frame_Interval_Last : 0.0);
+
+    NP32_Sim_Detach(&sim);
+    NP32_DeInit(&h);
+}
+#endif
+
+void Bench_Core_Run(void)
+{
+    uint8_t k;
+
+    Bench_Encode();
+    Bench_Encode_Table();
+    Bench_Buffer_Ops();
+    Bench_Bulk();
+    Bench_Brightness();
+    Bench_Dither();
+    Bench_HSV();
+    printf("\n== Simulated wire transfer (real timing, chunk 0 = full-frame buffer) ==\n");
+    printf("%8s %8s %8s %12s %14s %10s %10s %10s\n", "encoding", "LEDs", "chunk", "frame ms", "max cb us", "sim-under", "np32-under",
+           "mismatch");
+    Bench_Wire(NP32_ENCODING_PWM, 256, 0);
+    Bench_Wire(NP32_ENCODING_PWM, 1024, 0);
+    Bench_Wire(NP32_ENCODING_PWM, 1024, 8);
+    Bench_Wire(NP32_ENCODING_PWM, 1024, 32);
+    Bench_Wire(NP32_ENCODING_PWM, 4000, 16);
+    Bench_Wire(NP32_ENCODING_SPI3, 1024, 0);
+    Bench_Wire(NP32_ENCODING_SPI3, 1024, 8);
+    Bench_Wire(NP32_ENCODING_SPI4, 1024, 0);
+    Bench_Wire(NP32_ENCODING_SPI4, 1024, 8);
+    Bench_Wire(3, 1024, 0);
+    Bench_Wire(3, 1024, 8);
+    Bench_Static();
+
+    printf("\n== Pixel formats (simulated wire) ==\n");
+    printf("%8s %8s %8s %8s %10s %10s\n", "format", "encoding", "LEDs", "chunk", "DMA size", "mismatch");
+    for (k = 0; k < NP32_FORMAT_COUNT; k++)
+    {
+        Bench_Format(k, NP32_ENCODING_PWM, 256, 0);
+        Bench_Format(k, NP32_ENCODING_SPI3, 256, 8);
+        Bench_Format(k, NP32_ENCODING_SPI4, 256, 0);
+        Bench_Format(k, 3, 256, 16);
+    }
+
+    printf("\n== Prefix update (simulated wire, 64 frames, 1 of 8 frames changes an LED anywhere) ==\n");
+    printf("%8s %8s %8s %12s %12s %10s\n", "encoding", "LEDs", "touched", "full fps", "prefix fps", "mismatch");
+    Bench_Prefix(NP32_ENCODING_PWM, 1024, 32, 64);
+    Bench_Prefix(NP32_ENCODING_PWM, 1024, 512, 64);
+    Bench_Prefix(NP32_ENCODING_SPI3, 1024, 32, 64);
+
+    printf("\n== Power limiter (random frames, 1 to 16 LEDs changed per frame, 64 mixed operations and 24 direct writes checked) ==\n");
+    printf("%8s %10s %10s %8s %14s %14s %8s %10s\n", "LEDs", "budget mA", "est mA", "scale", "app us/frame",
+           "limit us/frame", "over", "mismatch");
+    Bench_Power(256, 2000, 1);
+    Bench_Power(1024, 5000, 1);
+    Bench_Power(1024, 5000, 16);
+
+#if defined(NP32_CFG_STATS)
+    printf("\n== Hot-path statistics (NP32_CFG_STATS, simulated wire, 20 updates) ==\n");
+    printf("%8s %8s %8s %8s %12s %12s %12s %12s %10s\n", "LEDs", "chunk", "sent", "skipped", "enc max us",
+           "wait max us", "dma us", "interval us", "fps");
+    Bench_Stats(256, 0);
+    Bench_Stats(1024, 0);
+    Bench_Stats(1024, 16);
+#endif
+}
@@ -0,0 +1,105 @@
+// np32_bench_group.c
+// Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+//
+// Benchmarks and checks of the instance group module (neopixel32_group.c).
+
+#include "np32_bench.h"
+#include "neopixel32_group.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Updates strips of 1/4, 2/4, 3/4 and 4/4 of the given length on separate simulated channels: One after another
+// (waiting for each frame) against a group update.
+static void Bench_Group(uint16_t led_count, uint32_t frames)
+{
+    NP32_Instance_t h[4];
+    NP32_Sim_t sim[4];
+    NP32_Group_t group;
+    NP32_RGB_t *col_buf;
+    uint64_t t_serial, t_group, t_fail;
+    uint32_t f, errors = 0;
+    uint8_t k;
+
+    memset(&group, 0, sizeof(NP32_Group_t));
+    for (k = 0; k < 4; k++)
+    {
+        memset(&h[k], 0, sizeof(NP32_Instance_t));
+        h[k].LED_Count = (uint16_t) ((led_count * (k + 1U)) / 4U);
+        if (NP32_Sim_Attach(&sim[k], &h[k]) != 0 || NP32_Init(&h[k]) != 0)
+        {
+            printf("%8u  (init failed)\n", led_count);
+            Bench_Mismatches++;
+            return;
+        }
+        group.Instances[k] = &h[k];
+    }
+    group.Instance_Count = 4;
+    if (NP32_Group_Init(&group) != 0)
+    {
+        printf("%8u  (group init failed)\n", led_count);
+        Bench_Mismatches++;
+        return;
+    }
+
+    t_serial = Bench_Now();
+    for (f = 0; f < frames; f++)
+    {
+        for (k = 0; k < 4; k++)
+        {
+            Bench_Random_Fill(&h[k]);
+            NP32_Update(&h[k]);
+            NP32_Sim_WaitIdle(&sim[k]);
+        }
+    }
+    t_serial = Bench_Now() - t_serial;
+
+    t_group = Bench_Now();
+    for (f = 0; f < frames; f++)
+    {
+        for (k = 0; k < 4; k++)
+            Bench_Random_Fill(&h[k]);
+        NP32_Group_Update(&group);
+    }
+    while (NP32_Group_IsBusy(&group));
+    t_group = Bench_Now() - t_group;
+
+    // Every frame has to be signalled once, and the last frame on each wire has to be the colour buffer.
+    if (group.Frames_Done != frames)
+        errors++;
+    for (k = 0; k < 4; k++)
+    {
+        NP32_Sim_WaitIdle(&sim[k]);
+        errors += Bench_Wire_Errors(&sim[k], &h[k], 0);
+    }
+
+    // A member failing to update (here: no colour buffer) must not keep the group busy.
+    col_buf = h[1].LED_Col_Buffer;
+    h[1].LED_Col_Buffer = NULL;
+    if (NP32_Group_Update(&group) != -1)
+        errors++;
+    h[1].LED_Col_Buffer = col_buf;
+    t_fail = Bench_Now();
+    while (NP32_Group_IsBusy(&group) && Bench_Now() - t_fail < 1000000000ULL);
+    if (NP32_Group_IsBusy(&group))
+        errors++;
+    for (k = 0; k < 4; k++)
+        NP32_Sim_WaitIdle(&sim[k]);
+
+    printf("%8u %12.1f %12.1f %10u\n", led_count, frames * 1e9 / t_serial, frames * 1e9 / t_group, Bench_Check(errors));
+
+    NP32_Group_DeInit(&group);
+    for (k = 0; k < 4; k++)
+    {
+        NP32_Sim_Detach(&sim[k]);
+        NP32_DeInit(&h[k]);
+    }
+}
+
+void Bench_Group_Run(void)
+{
+    printf("\n== Group update (4 strips of 1/4 to 4/4 LEDs, simulated wire, 20 frames) ==\n");
+    printf("%8s %12s %12s %10s\n", "LEDs", "serial fps", "group fps", "mismatch");
+    Bench_Group(256, 20);
+    Bench_Group(1024, 20);
+}
@@ -0,0 +1,127 @@
+// np32_bench_matrix.c
+// Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+//
+// Benchmarks and checks of the matrix module (neopixel32_matrix.c).
+
+#include "np32_bench.h"
+#include "neopixel32_matrix.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Reference of a serpentine panel of 16x16 tiles, computed per pixel like an application would do it.
+static uint16_t Bench_Matrix_XY(uint16_t x, uint16_t y, uint16_t width)
+{
+    uint16_t tx = x / 16, ty = y / 16, lx = x % 16, ly = y % 16;
+
+    if (ly & 0x01)
+        lx = 15 - lx;
+
+    return (uint16_t) ((((ty * (width / 16)) + tx) * 256) + (ly * 16) + lx);
+}
+
+// Matrix view of 16x16 tiles: Drawing a frame with the map against computing the index per pixel, and scrolling.
+static void Bench_Matrix(uint16_t width, uint16_t height)
+{
+    NP32_Instance_t h;
+    NP32_Matrix_t m;
+    NP32_RGB_t *frame, col;
+    uint8_t *seen;
+    double ns_xy, ns_blit, ns_scroll;
+    uint32_t i, errors = 0;
+    uint16_t x, y;
+
+    if (Bench_Init(&h, width * height, NP32_ENCODING_PWM, NULL) != 0)
+        return;
+    memset(&m, 0, sizeof(NP32_Matrix_t));
+    m.Instance = &h;
+    m.Width = width;
+    m.Height = height;
+    m.Layout = NP32_MATRIX_SERPENTINE;
+
+    // A failed init (tiles not dividing the panel) keeps the configuration and leaves the matrix unusable.
+    m.Tile_Width = 15;
+    m.Tile_Height = 16;
+    if (NP32_Matrix_Init(&m, NULL) != -1 || m.Tile_Width != 15 || m.Tile_Height != 16)
+        errors++;
+    if (NP32_Matrix_Index(&m, 0, 0) != 0xFFFFU || NP32_Matrix_SetPixel(&m, 0, 0, NP32_COL_BLACK) != -1)
+        errors++;
+
+    m.Tile_Width = 16;
+    if (NP32_Matrix_Init(&m, NULL) != 0)
+    {
+        printf("%5ux%-5u  (init failed)\n", width, height);
+        Bench_Mismatches++;
+        return;
+    }
+    frame = (NP32_RGB_t *) malloc((size_t) width * height * sizeof(NP32_RGB_t));
+    seen = (uint8_t *) calloc(h.LED_Count, 1);
+    for (i = 0; i < (uint32_t) width * height; i++)
+        frame[i] = (NP32_RGB_t){ rand() & 0xFF, rand() & 0xFF, rand() & 0xFF };
+
+    // The map has to match the reference.
+    for (y = 0; y < height; y++)
+    {
+        for (x = 0; x < width; x++)
+        {
+            if (NP32_Matrix_Index(&m, x, y) != Bench_Matrix_XY(x, y, width))
+                errors++;
+        }
+    }
+
+    BENCH_RUN(ns_xy, for (y = 0; y < height; y++)
+                     {
+                         for (x = 0; x < width; x++)
+                             NP32_SetLED_RGB(&h, Bench_Matrix_XY(x, y, width), frame[(y * width) + x]);
+                     });
+    BENCH_RUN(ns_blit, NP32_Matrix_Blit(&m, 0, 0, frame, width, height, NULL));
+    BENCH_RUN(ns_scroll, NP32_Matrix_Scroll(&m, -1, 0, NP32_COL_BLACK));
+
+    // Check a scroll by (-3, 2) against the frame.
+    NP32_Matrix_Blit(&m, 0, 0, frame, width, height, NULL);
+    NP32_Matrix_Scroll(&m, -3, 2, NP32_COL_BLACK);
+    for (y = 0; y < height; y++)
+    {
+        for (x = 0; x < width; x++)
+        {
+            NP32_Matrix_GetPixel(&m, x, y, &col);
+            if (x + 3 < width && y >= 2)
+                errors += (memcmp(&col, &frame[((y - 2) * width) + x + 3], sizeof(NP32_RGB_t)) != 0);
+            else
+                errors += (col.R | col.G | col.B) != 0;
+        }
+    }
+
+    // The rotated views have to map every LED exactly once.
+    for (m.Rotation = 1; m.Rotation < 4; m.Rotation++)
+    {
+        m.Layout = NP32_MATRIX_SERPENTINE | NP32_MATRIX_COLUMNS | NP32_MATRIX_TILES_SERPENTINE;
+        NP32_Matrix_DeInit(&m);
+        NP32_Matrix_Init(&m, NULL);
+        memset(seen, 0, h.LED_Count);
+        for (i = 0; i < (uint32_t) width * height; i++)
+            seen[m._Map[i]]++;
+        for (i = 0; i < h.LED_Count; i++)
+            errors += (seen[i] != 1);
+    }
+
+    // After the de-init, the pixel accessors fail instead of reading the freed map.
+    NP32_Matrix_DeInit(&m);
+    if (NP32_Matrix_Index(&m, 0, 0) != 0xFFFFU || NP32_Matrix_GetPixel(&m, 0, 0, &col) != -1)
+        errors++;
+
+    printf("%5ux%-5u %14.2f %14.2f %14.2f %10u\n", width, height, ns_xy / 1000.0, ns_blit / 1000.0,
+           ns_scroll / 1000.0, Bench_Check(errors));
+
+    free(frame);
+    free(seen);
+    NP32_DeInit(&h);
+}
+
+void Bench_Matrix_Run(void)
+{
+    printf("\n== Matrix (16x16 serpentine tiles, full frame) ==\n");
+    printf("%11s %14s %14s %14s %10s\n", "size", "per-pixel us", "blit us", "scroll us", "mismatch");
+    Bench_Matrix(32, 32);
+    Bench_Matrix(64, 32);
+}
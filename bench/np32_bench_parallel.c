@@ -0,0 +1,80 @@
+// np32_bench_parallel.c
+// Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+//
+// Benchmarks and checks of the parallel output module (neopixel32_parallel.c).
+
+#include "np32_bench.h"
+#include "neopixel32_parallel.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int8_t Bench_Parallel_StartDMA(uint16_t *buf, uint16_t len)
+{
+    Bench_Sink += buf[len - 1];
+    return 0;
+}
+
+static void Bench_Parallel(uint8_t strips, uint16_t led_count)
+{
+    NP32_Instance_t inst[NP32_PARALLEL_MAX_STRIPS];
+    NP32_Parallel_t group;
+    NP32_RGB_t col;
+    uint32_t errors = 0;
+    double ns;
+    uint16_t i, plane;
+    uint8_t k, b, byte;
+
+    memset(&group, 0, sizeof(NP32_Parallel_t));
+    for (k = 0; k < strips; k++)
+    {
+        memset(&inst[k], 0, sizeof(NP32_Instance_t));
+        inst[k].LED_Count = led_count - k;
+        group.Strips[k] = &inst[k];
+    }
+    group.Strip_Count = strips;
+    group.StartDMA_Call = Bench_Parallel_StartDMA;
+    if (NP32_Parallel_Init(&group) != 0)
+    {
+        printf("%8u %8u  (init failed)\n", strips, led_count);
+        Bench_Mismatches++;
+        return;
+    }
+    for (k = 0; k < strips; k++)
+        Bench_Random_Fill(&inst[k]);
+
+    // Each update completes right away, mark all LEDs of the first strip as changed to force a full transpose.
+    BENCH_RUN(ns, NP32_MarkDirty(&inst[0], 0, inst[0].LED_Count - 1); NP32_Parallel_Update(&group);
+              NP32_Parallel_DMAComplete_Callback(&group));
+
+    // Check the planes against the colour buffers: A cleared bit k means strip k sends a 1 bit.
+    for (k = 0; k < strips; k++)
+    {
+        for (i = 0; i < group._LED_Count; i++)
+        {
+            col = (i < inst[k].LED_Count) ? inst[k].LED_Col_Buffer[i] : NP32_COL_BLACK;
+            for (b = 0; b < 24; b++)
+            {
+                byte = (b < 8) ? col.G : ((b < 16) ? col.R : col.B);
+                plane = group._Plane_Buffer[i * 24 + b];
+                if ((((byte >> (7 - (b % 8))) & 0x01) == 1) != (((plane >> k) & 0x01) == 0))
+                    errors++;
+            }
+        }
+    }
+
+    printf("%8u %8u %14.2f %16.2f %10u\n", strips, led_count, ns / 1000.0, ns / ((double) led_count * strips),
+           Bench_Check(errors));
+
+    NP32_Parallel_DeInit(&group);
+}
+
+void Bench_Parallel_Run(void)
+{
+    printf("\n== Parallel bit-plane encode (full transpose) ==\n");
+    printf("%8s %8s %14s %16s %10s\n", "strips", "LEDs", "us/frame", "ns/LED/strip", "mismatch");
+    Bench_Parallel(8, 256);
+    Bench_Parallel(8, 1024);
+    Bench_Parallel(16, 256);
+    Bench_Parallel(16, 1024);
+}
@@ -0,0 +1,116 @@
+// np32_bench_seq.c
+// Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+//
+// Benchmarks and checks of the sequence module (neopixel32_seq.c).
+
+#include "np32_bench.h"
+#include "neopixel32_seq.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Compressed sequence of a comet of the given length running over a static background: Coded size, decode time and
+// encode time of the frames against loading the raw frames. Seeking is timed on a copy with a keyframe every 32 frames.
+static void Bench_Seq(uint16_t led_count, uint16_t comet, uint16_t frames)
+{
+    NP32_Instance_t h;
+    NP32_Seq_t seq;
+    NP32_RGB_t *raw, *cur, col;
+    uint8_t *data, *data_key;
+    double ns_raw = 0, ns_seq = 0, ns_seek = 0;
+    uint64_t t;
+    uint32_t size = NP32_SEQ_HEADER_SIZE, size_key = NP32_SEQ_HEADER_SIZE, errors = 0;
+    uint16_t f, i, seeks = 0;
+
+    if (Bench_Init(&h, led_count, NP32_ENCODING_PWM, NULL) != 0)
+        return;
+    raw = (NP32_RGB_t *) malloc((size_t) frames * led_count * sizeof(NP32_RGB_t));
+    data = (uint8_t *) malloc(NP32_SEQ_HEADER_SIZE + (frames * NP32_SEQ_FRAME_MAX_SIZE(led_count)));
+    data_key = (uint8_t *) malloc(NP32_SEQ_HEADER_SIZE + (frames * NP32_SEQ_FRAME_MAX_SIZE(led_count)));
+    for (f = 0; f < frames; f++)
+    {
+        cur = &raw[(uint32_t) f * led_count];
+        for (i = 0; i < led_count; i++)
+            cur[i] = (NP32_RGB_t){ (uint8_t) (i / 16), 0, 32 };
+        for (i = 0; i < comet; i++)
+            cur[(f + i) % led_count] = (NP32_RGB_t){ 255, (uint8_t) (i * 255 / comet), 0 };
+    }
+    NP32_Seq_EncodeHeader(data, led_count, frames);
+    NP32_Seq_EncodeHeader(data_key, led_count, frames);
+    for (f = 0; f < frames; f++)
+    {
+        size += NP32_Seq_EncodeFrame((f == 0) ? NULL : &raw[(uint32_t) (f - 1) * led_count],
+                                     &raw[(uint32_t) f * led_count], led_count, 20, data + size);
+        size_key += NP32_Seq_EncodeFrame((f % 32 == 0) ? NULL : &raw[(uint32_t) (f - 1) * led_count],
+                                         &raw[(uint32_t) f * led_count], led_count, 20, data_key + size_key);
+    }
+
+    // Loading the raw frames re-encodes all LEDs.
+    for (f = 0; f < frames; f++)
+    {
+        t = Bench_Now();
+        NP32_SetLEDs_RGB(&h, 0, &raw[(uint32_t) f * led_count], led_count);
+        NP32_Update(&h);
+        ns_raw += Bench_Now() - t;
+    }
+
+    memset(&seq, 0, sizeof(NP32_Seq_t));
+    seq.Instance = &h;
+    seq.Data = data;
+    seq.Size = size;
+    if (NP32_Seq_Init(&seq) != 0)
+        errors++;
+    for (f = 0; f < frames; f++)
+    {
+        t = Bench_Now();
+        if (NP32_Seq_Next(&seq) != 1)
+            errors++;
+        NP32_Update(&h);
+        ns_seq += Bench_Now() - t;
+
+        for (i = 0; i < led_count; i++)
+        {
+            NP32_GetLED_RGB(&h, i, &col);
+            errors += (memcmp(&col, &raw[((uint32_t) f * led_count) + i], sizeof(NP32_RGB_t)) != 0);
+        }
+    }
+    errors += (NP32_Seq_Next(&seq) != 0);
+
+    // Seek backwards to every 16th frame, so every seek starts over from a keyframe.
+    seq.Data = data_key;
+    seq.Size = size_key;
+    if (NP32_Seq_Init(&seq) != 0)
+        errors++;
+    for (f = frames; f >= 16; f -= 16)
+    {
+        t = Bench_Now();
+        if (NP32_Seq_Seek(&seq, f - 1) != 0)
+            errors++;
+        ns_seek += Bench_Now() - t;
+        seeks++;
+
+        for (i = 0; i < led_count; i++)
+        {
+            NP32_GetLED_RGB(&h, i, &col);
+            errors += (memcmp(&col, &raw[((uint32_t) (f - 1) * led_count) + i], sizeof(NP32_RGB_t)) != 0);
+        }
+    }
+
+    printf("%8u %8u %12u %12u %14.2f %14.2f %12.2f %10u\n", led_count, comet, frames * led_count * 3, size,
+           ns_raw / frames / 1000.0, ns_seq / frames / 1000.0, ns_seek / seeks / 1000.0, Bench_Check(errors));
+
+    free(raw);
+    free(data);
+    free(data_key);
+    NP32_DeInit(&h);
+}
+
+void Bench_Seq_Run(void)
+{
+    printf("\n== Compressed sequence (comet over a static background, 256 frames, seek with a keyframe every 32 frames) ==\n");
+    printf("%8s %8s %12s %12s %14s %14s %12s %10s\n", "LEDs", "comet", "raw bytes", "coded bytes", "raw us/frame",
+           "seq us/frame", "seek us", "mismatch");
+    Bench_Seq(256, 16, 256);
+    Bench_Seq(1024, 16, 256);
+    Bench_Seq(1024, 128, 256);
+}
@@ -18,29 +18,277 @@
 
 #include <stdint.h>
 
+/*
+ * Build configuration:
+ *   NP32_CFG_DMA_BYTE_BUFFER - If defined, the DMA buffer holds the compare values as bytes instead of half-words.
+ *                              This halves the memory footprint of the DMA buffer, but requires the DMA stream to be
+ *                              configured with a memory data width of a byte and a peripheral data width of a
+ *                              half-word (or word). All compare values of the timing have to fit into a byte.
+ *   NP32_WS2812_TIM_PERIOD,
+ *   NP32_WS2812_0_TIME,
+ *   NP32_WS2812_1_TIME,
+ *   NP32_WS2812_ZERO_PERIODS - The compile-time timing profile (see below). Can be overridden at build time, the
+ *                              encoder tables get generated from these constants.
+ *   NP32_CFG_DMA_SECTION     - Optional linker section (e.g. ".dma_buffer") of the DMA buffers defined by
+ *                              \ref NP32_DEFINE_INSTANCE, for placing them in a RAM region reachable by the DMA.
+ *   NP32_CFG_DMA_ALIGN       - The alignment of the DMA buffers defined by \ref NP32_DEFINE_INSTANCE in bytes
+ *                              (default and minimum: 4).
+ *   NP32_CFG_GRB_ONLY        - If defined, only the encoders of the GRB pixel format get built, which saves the
+ *                              flash memory of the encoders of the other formats (see \ref NP32_FORMAT_GRB).
+ *   NP32_CFG_STATS           - If defined, each instance records statistics of its hot path (encode time, busy-wait
+ *                              time, DMA transfer time, sent and skipped frames), see \ref NP32_GetStats.
+ *   NP32_CFG_STATS_TIME()    - The timestamp source of the statistics, an expression returning a free-running
+ *                              uint32_t counter. Default: The DWT cycle counter (enabled by \ref NP32_Init), so the
+ *                              times are CPU cycles. In the host build, the default is a monotonic clock in
+ *                              nanoseconds.
+ *   NP32_CFG_BLEND_NO_SIMD   - If defined, the blending operations (see neopixel32_blend.h) use the portable code
+ *                              instead of the SIMD instructions of the target.
+ *   NP32_CFG_HOST            - Defined by the host build ("make host"), which runs the library on the build machine
+ *                              with the simulated DMA / PWM backend of neopixel32_sim.h.
+ */
+
 /**
  * \brief The timer count period at a CPU clock frequency of 72MHz.
  * \note 1 clock cycle @ 72MHz = 13.88ns; 1 clock cycle of 1 bit sent to the neopixel / WS2812 LED = 1.3μs -> 93.6 *
  *       13.88ns = 1300ns. The cycle count gets rounded to 94. As the timer starts counting @0 -> 93.
  */
+#if !defined(NP32_WS2812_TIM_PERIOD)
 #define NP32_WS2812_TIM_PERIOD          93U
+#endif
 
 /**
  * \brief The number of timer counts to reach the high time of a 0 bit.
  * \note T0H = 400ns (of 1300ns) -> (4/13) * 94 = 28.92 -> rounded to 29. As the timer starts counting @0 -> 28.
  */
+#if !defined(NP32_WS2812_0_TIME)
 #define NP32_WS2812_0_TIME              28U
+#endif
 
 /**
  * \brief The number of timer counts to reach the high time of a 1 bit.
  * \note T0H = 700ns (of 1300ns) -> (7/13) * 94 = 50.61 -> rounded to 51. As the timer starts counting @0 -> 50.
  */
-#define NP32_WS2812_1_TIME              50U 
+#if !defined(NP32_WS2812_1_TIME)
+#define NP32_WS2812_1_TIME              50U
+#endif
 
 /**
  * \brief The amount of zero-periods sent after the LED data as a reset command.
  */
+#if !defined(NP32_WS2812_ZERO_PERIODS)
 #define NP32_WS2812_ZERO_PERIODS        48U
+#endif
+
+/**
+ * \brief The number of timer periods (DMA buffer entries) needed to transmit the data of a single LED.
+ */
+#define NP32_WS2812_PERIODS_PER_LED     24U
+
+/**
+ * \brief Encoding: Each bit is sent as a PWM period, the DMA buffer holds one timer compare value per bit (default).
+ */
+#define NP32_ENCODING_PWM               0U
+
+/**
+ * \brief Encoding: Each bit is sent as a 3-bit SPI symbol (1 = 110, 0 = 100) at a SPI clock of 2.4MHz. The DMA buffer
+ *        holds 9 bytes per LED.
+ */
+#define NP32_ENCODING_SPI3              1U
+
+/**
+ * \brief Encoding: Each bit is sent as a 4-bit SPI symbol (1 = 1110, 0 = 1000) at a SPI clock of 3.2MHz. The DMA
+ *        buffer holds 12 bytes per LED.
+ */
+#define NP32_ENCODING_SPI4              2U
+
+/**
+ * \brief Pixel format: 8 bits per channel, sent in the order green, red, blue (WS2812 / WS2812B, SK6812 RGB; default).
+ */
+#define NP32_FORMAT_GRB                 0U
+
+/**
+ * \brief Pixel format: 8 bits per channel, sent in the order red, green, blue (e.g. WS2811, APA106).
+ */
+#define NP32_FORMAT_RGB                 1U
+
+/**
+ * \brief Pixel format: 8 bits per channel, sent in the order blue, red, green.
+ */
+#define NP32_FORMAT_BRG                 2U
+
+/**
+ * \brief Pixel format: 8 bits per channel, sent in the order green, red, blue, white (SK6812 RGBW). The white channel
+ *        gets the common part of red, green and blue (white = min(R, G, B), which gets subtracted from the colour
+ *        channels), so the LED shows the colour of the colour buffer with the white LED doing most of the work.
+ */
+#define NP32_FORMAT_GRBW                3U
+
+/**
+ * \brief Pixel format: 16 bits per channel (MSB first), sent in the order green, red, blue (e.g. WS2816). The 8-bit
+ *        value v of the colour buffer gets sent as v * 257, so 255 is the full 16-bit scale. For the full 16-bit
+ *        precision, enable the high-precision colour buffer (see \ref NP32_EnableDither), whose values get sent
+ *        directly.
+ */
+#define NP32_FORMAT_GRB16               4U
+
+/**
+ * \brief The count of pixel formats.
+ */
+#define NP32_FORMAT_COUNT               5U
+
+/**
+ * \brief The count of bytes sent to a single LED in the given pixel format.
+ */
+#define NP32_FORMAT_BYTES(fmt)          (((fmt) == NP32_FORMAT_GRBW) ? 4U : (((fmt) == NP32_FORMAT_GRB16) ? 6U : 3U))
+
+/**
+ * \brief Converts a duration in nanoseconds into timer counts at the given timer clock (rounded to the nearest count).
+ */
+#define NP32_NS_TO_COUNTS(clk_hz,ns)    ((uint32_t) ((((uint64_t) (clk_hz) * (ns)) + 500000000ULL) / 1000000000ULL))
+
+// A compare value of NP32_TIMING_INIT: The counts decremented by 1, or 0 (an invalid profile) if out of the range of
+// the DMA buffer entries, so an over-range profile gets rejected by NP32_Init instead of wrapping around.
+#define _NP32_TIMING_COUNT(clk_hz,ns)                                                                               \
+    ((uint16_t) (((NP32_NS_TO_COUNTS(clk_hz, ns) - 1) > NP32_DMA_MAX) ? 0 : (NP32_NS_TO_COUNTS(clk_hz, ns) - 1)))
+
+/**
+ * \brief Initialiser of a constant \ref NP32_Timing_t, computed from the timer clock and the target bit period, high
+ *        times and reset time (all in nanoseconds). As the timer starts counting at 0, all counts get decremented by 1.
+ *        Counts out of the range of the DMA buffer entries make the profile invalid (\ref NP32_Init fails).
+ *        Example (WS2812B at 72MHz, 1.25us bit period, 50us reset):
+ *        static const NP32_Timing_t timing = NP32_TIMING_INIT(72000000, 1250, 400, 800, 50000);
+ */
+#define NP32_TIMING_INIT(clk_hz,bit_ns,t0h_ns,t1h_ns,reset_ns)                                                     \
+    {                                                                                                               \
+        _NP32_TIMING_COUNT(clk_hz, bit_ns),                                                                         \
+        _NP32_TIMING_COUNT(clk_hz, t0h_ns),                                                                         \
+        _NP32_TIMING_COUNT(clk_hz, t1h_ns),                                                                         \
+        (uint16_t) (((reset_ns) + (bit_ns) - 1) / (bit_ns)),                                                        \
+        _NP32_TIMING_LUT(_NP32_TIMING_COUNT(clk_hz, t0h_ns), _NP32_TIMING_COUNT(clk_hz, t1h_ns))                    \
+    }
+
+// The bit encoding table of NP32_TIMING_INIT: Rows of the 4 compare values of a nibble (bit 3 first), packed into words
+// in DMA buffer order (see NP32_Timing_t::_LUT).
+#define _NP32_TIMING_BIT(n,b,t0,t1)     ((uint32_t) ((((n) >> (b)) & 0x01) ? (t1) : (t0)))
+#if defined(NP32_CFG_DMA_BYTE_BUFFER)
+#define _NP32_TIMING_ROW(n,t0,t1)                                                                                   \
+    { _NP32_TIMING_BIT(n, 3, t0, t1) | (_NP32_TIMING_BIT(n, 2, t0, t1) << 8) |                                      \
+      (_NP32_TIMING_BIT(n, 1, t0, t1) << 16) | (_NP32_TIMING_BIT(n, 0, t0, t1) << 24) }
+#else
+#define _NP32_TIMING_ROW(n,t0,t1)                                                                                   \
+    { _NP32_TIMING_BIT(n, 3, t0, t1) | (_NP32_TIMING_BIT(n, 2, t0, t1) << 16),                                      \
+      _NP32_TIMING_BIT(n, 1, t0, t1) | (_NP32_TIMING_BIT(n, 0, t0, t1) << 16) }
+#endif
+#define _NP32_TIMING_LUT(t0,t1)                                                                                     \
+    { _NP32_TIMING_ROW(0x0, t0, t1), _NP32_TIMING_ROW(0x1, t0, t1), _NP32_TIMING_ROW(0x2, t0, t1),                  \
+      _NP32_TIMING_ROW(0x3, t0, t1), _NP32_TIMING_ROW(0x4, t0, t1), _NP32_TIMING_ROW(0x5, t0, t1),                  \
+      _NP32_TIMING_ROW(0x6, t0, t1), _NP32_TIMING_ROW(0x7, t0, t1), _NP32_TIMING_ROW(0x8, t0, t1),                  \
+      _NP32_TIMING_ROW(0x9, t0, t1), _NP32_TIMING_ROW(0xA, t0, t1), _NP32_TIMING_ROW(0xB, t0, t1),                  \
+      _NP32_TIMING_ROW(0xC, t0, t1), _NP32_TIMING_ROW(0xD, t0, t1), _NP32_TIMING_ROW(0xE, t0, t1),                  \
+      _NP32_TIMING_ROW(0xF, t0, t1) }
+
+#if defined(NP32_CFG_DMA_BYTE_BUFFER)
+#if NP32_WS2812_TIM_PERIOD > 0xFFU
+#error "NP32_CFG_DMA_BYTE_BUFFER requires all timer compare values to fit into a byte."
+#endif
+/**
+ * \brief The data type of a single entry (compare value) of the DMA buffer.
+ */
+typedef uint8_t NP32_DMA_t;
+/**
+ * \brief The largest compare value fitting into an entry of the DMA buffer.
+ */
+#define NP32_DMA_MAX                    0xFFU
+#else
+typedef uint16_t NP32_DMA_t;
+#define NP32_DMA_MAX                    0xFFFFU
+#endif
+
+/**
+ * \brief The size of the DMA buffer (in entries) of an instance with the given LED count, which uses the PWM encoding
+ *        with the compile-time timing profile.
+ */
+#define NP32_DMA_BUF_ENTRIES(leds)      NP32_DMA_BUF_ENTRIES_FMT(leds, NP32_FORMAT_GRB)
+
+/**
+ * \brief The size of the DMA buffer (in entries) of an instance with the given LED count and pixel format, which uses
+ *        the PWM encoding with the compile-time timing profile.
+ */
+#define NP32_DMA_BUF_ENTRIES_FMT(leds,fmt)                                                                          \
+    (((uint32_t) (leds) * NP32_FORMAT_BYTES(fmt) * 8U) + NP32_WS2812_ZERO_PERIODS)
+
+/**
+ * \brief The size of the DMA buffer (in entries) of an instance in streaming mode with the given chunk size (see
+ *        \ref NP32_Instance_t::Stream_Chunk_LEDs), which uses the PWM encoding.
+ */
+#define NP32_STREAM_DMA_BUF_ENTRIES(chunk) NP32_STREAM_DMA_BUF_ENTRIES_FMT(chunk, NP32_FORMAT_GRB)
+
+/**
+ * \brief The size of the DMA buffer (in entries) of an instance in streaming mode with the given chunk size and pixel
+ *        format, which uses the PWM encoding.
+ */
+#define NP32_STREAM_DMA_BUF_ENTRIES_FMT(chunk,fmt) (2UL * (uint32_t) (chunk) * NP32_FORMAT_BYTES(fmt) * 8U)
+
+/**
+ * \brief The size of the colour correction table of an instance in bytes (see \ref NP32_InitStatic).
+ */
+#define NP32_COL_LUT_SIZE               (3U * 256U)
+
+/**
+ * \brief The size of the quantisation error buffer of the temporal dithering in bytes (see \ref NP32_EnableDither).
+ */
+#define NP32_DITHER_ERR_SIZE(leds)      (3U * (uint32_t) (leds))
+
+/**
+ * \brief The current of a single channel of a WS2812 LED at full intensity in µA (see \ref NP32_SetPowerLimit).
+ */
+#define NP32_WS2812_CHANNEL_UA          20000U
+
+/**
+ * \brief The quiescent current of a WS2812 LED (all channels off) in µA (see \ref NP32_SetPowerLimit).
+ */
+#define NP32_WS2812_IDLE_UA             1000U
+
+#if !defined(NP32_CFG_DMA_ALIGN)
+#define NP32_CFG_DMA_ALIGN              4
+#endif
+
+/**
+ * \brief Attributes of the DMA buffers defined by \ref NP32_DEFINE_INSTANCE: Word alignment (needed by the encoder)
+ *        and the optional linker section given by NP32_CFG_DMA_SECTION.
+ */
+#if defined(NP32_CFG_DMA_SECTION)
+#define NP32_DMA_BUF_ATTR               __attribute__((section(NP32_CFG_DMA_SECTION), aligned(NP32_CFG_DMA_ALIGN)))
+#else
+#define NP32_DMA_BUF_ATTR               __attribute__((aligned(NP32_CFG_DMA_ALIGN)))
+#endif
+
+/**
+ * \brief Defines an instance with the given LED count together with its statically allocated colour and DMA buffers
+ *        (PWM encoding with the compile-time timing profile). The buffers get the names name_Col_Buffer and
+ *        name_DMA_Buffer, the instance gets initialised with \ref NP32_INIT_STATIC. Example:
+ *        NP32_DEFINE_INSTANCE(strip, 60);
+ *        ...
+ *        strip.StartDMA_Call = Strip_StartDMA;
+ *        NP32_INIT_STATIC(strip);
+ */
+#define NP32_DEFINE_INSTANCE(name,leds)  NP32_DEFINE_INSTANCE_FMT(name, leds, NP32_FORMAT_GRB)
+
+/**
+ * \brief Like \ref NP32_DEFINE_INSTANCE, but for LEDs with the given pixel format (e.g. \ref NP32_FORMAT_GRBW).
+ */
+#define NP32_DEFINE_INSTANCE_FMT(name,leds,fmt)                                                                     \
+    static NP32_RGB_t name##_Col_Buffer[(leds)];                                                                    \
+    static NP32_DMA_t name##_DMA_Buffer[NP32_DMA_BUF_ENTRIES_FMT(leds, fmt)] NP32_DMA_BUF_ATTR;                      \
+    NP32_Instance_t name = { .LED_Count = (leds), .Format = (fmt) }
+
+/**
+ * \brief Initialises an instance defined by \ref NP32_DEFINE_INSTANCE with its static buffers (see
+ *        \ref NP32_InitStatic).
+ */
+#define NP32_INIT_STATIC(name)                                                                                      \
+    NP32_InitStatic(&(name), name##_Col_Buffer, name##_DMA_Buffer, sizeof(name##_DMA_Buffer) / sizeof(NP32_DMA_t), \
+                    (uint8_t *) 0)
 
 /**
  * \brief This macro gets the given bit of the given value (0 = LSB, 7 = MSB) and returns \ref NP32_WS2812_1_TIME if the
@@ -50,6 +298,64 @@
 
 #define NP32_COL_BLACK                  ((NP32_RGB_t){ 0x00, 0x00, 0x00 })
 
+/**
+ * \brief The count of hue steps of the full-scale HSV functions (\ref NP32_HSV8_To_RGB): 256 steps per sector of the
+ *        colour wheel, so the hue ranges from 0 to 1535.
+ */
+#define NP32_HSV8_HUE_STEPS             1536U
+
+/**
+ * \brief Converts an 8-bit hue (0 to 255 for the whole colour wheel) to the hue scale of the full-scale HSV functions.
+ */
+#define NP32_HUE8_TO_HSV8(h)            ((uint16_t) ((uint8_t) (h) * 6U))
+
+typedef struct __NP32_Instance   NP32_Instance_t;
+
+/**
+ * \brief Statistics of the hot path of an instance (see \ref NP32_GetStats). Only recorded if the library is built
+ *        with NP32_CFG_STATS. All times are given in ticks of the timestamp source (NP32_CFG_STATS_TIME).
+ */
+struct __NP32_Stats
+{
+    uint32_t Frames_Sent; /**< The count of frames transmitted completely (including the reset periods). */
+    uint32_t Frames_Skipped; /**< The count of frames queued by \ref NP32_UpdateAsync, which got replaced by a newer
+                                  frame before being started. */
+    uint32_t Encode_Time_Last; /**< The time of the last encode of the DMA buffer (in streaming mode: of a ring
+                                    half). */
+    uint32_t Encode_Time_Max; /**< The longest time of an encode of the DMA buffer (or of a ring half). */
+    uint64_t Encode_Time_Total; /**< The total time spent encoding. */
+    uint32_t Wait_Time_Max; /**< The longest time \ref NP32_Update spent waiting for the previous frame. */
+    uint64_t Wait_Time_Total; /**< The total time \ref NP32_Update spent waiting for the previous frame. */
+    uint32_t DMA_Time_Last; /**< The time of the last DMA transfer from its start to its completion. */
+    uint32_t DMA_Time_Max; /**< The longest time of a DMA transfer. */
+    uint32_t Frame_Interval_Last; /**< The time between the starts of the last two frames (the inverse of the frame
+                                       rate). 0 until two frames have been started. */
+};
+
+typedef struct __NP32_Stats      NP32_Stats_t;
+
+/**
+ * \brief A timing profile of the PWM encoding: The timer period and compare values of the bits, and the length of the
+ *        reset. Instances without a timing profile use the compile-time profile (\ref NP32_WS2812_TIM_PERIOD,
+ *        \ref NP32_WS2812_0_TIME, \ref NP32_WS2812_1_TIME and \ref NP32_WS2812_ZERO_PERIODS), which gets encoded
+ *        through a constant table in flash. A profile has to be created by \ref NP32_Timing_Compute or
+ *        \ref NP32_TIMING_INIT, which also fill its bit encoding table, so instances sharing a profile share its
+ *        table and instances without a profile do not need any memory for it.
+ */
+struct __NP32_Timing
+{
+    uint16_t Period; /**< The timer period (auto-reload value) of a single bit. Has to be configured in the timer by the
+                          HAL, the library does not use it itself. */
+    uint16_t T0H; /**< The compare value of a 0 bit. */
+    uint16_t T1H; /**< The compare value of a 1 bit. */
+    uint16_t Reset_Periods; /**< The amount of zero-periods sent after the LED data as a reset command. */
+    uint32_t _LUT[16][(4 * sizeof(NP32_DMA_t)) / 4]; /**< Bit encoding table of the profile: Maps a nibble to the
+                                                          compare values of its 4 bits (bit 3 first), packed in DMA
+                                                          buffer order. */
+};
+
+typedef struct __NP32_Timing     NP32_Timing_t;
+
 /**
  * \brief Data structure that represents a RGB-value of a neopixel LED.
  */
@@ -70,6 +376,18 @@ struct __NP32_HSV
     uint8_t V;  /**< The value (brightness) of the represented colour. */
 };
 
+/**
+ * \brief Data structure that represents a high-precision RGB-value (16 bits per channel) of a neopixel LED, used by the
+ *        temporal dithering (see \ref NP32_EnableDither). The upper byte is the 8-bit value, the lower byte the
+ *        fraction between two 8-bit values.
+ */
+struct __NP32_RGB16
+{
+    uint16_t R; /**< The red component of represented colour. */
+    uint16_t G; /**< The green component of represented colour. */
+    uint16_t B; /**< The blue component of represented colour. */
+};
+
 /**
  * \brief Represents an instance of neopixel / WS2812 LEDs controlled by a single PWM pin on the processor. This struct
  *        enables the feature of having multiple pins controlling multiple arrays of neopixel / WS2812 LEDs on a single
@@ -80,25 +398,176 @@ struct __NP32_Instance
     uint16_t LED_Count; /**< The count of LEDs in the array this instance represents. */
 
     struct __NP32_RGB *LED_Col_Buffer; /**< The pointer to the LED colour buffer, which holds the values of all LEDs in
-                                              the LED array this instance represents.*/
+                                              the LED array this instance represents. After rotating or shifting the
+                                              LEDs, the buffer is a ring, which does not start at LED 0 (see
+                                              \ref NP32_Normalize). */
 
     uint8_t LED_Disable_Flag; /**< This flag enables (if set to 1) the LED disable mode. In this mode, the colour buffer
                                    is still present (and can still be manipulated by the program), but the LEDs all get
                                    set to black. This enables a global shutoff of the LEDs without emptying the colour
                                    buffer. */
 
-    uint16_t *_DMA_Buffer; /**< The pointer to the DMA half-word buffer, which holds the raw PWM information to output
-                                to the LED data in pin of the LED array this instance represents. */
+    uint8_t Prefix_Update_Flag; /**< This flag enables (if set to 1) the prefix update mode. In this mode,
+                                     \ref NP32_Update only transmits the LEDs up to the highest LED, which changed
+                                     since the last frame, followed by the reset periods. The LEDs behind keep the
+                                     colour latched before, so the frame time only depends on the position of the
+                                     changes. Not supported in streaming mode (ignored). */
+
+    NP32_DMA_t *_DMA_Buffer; /**< The pointer to the DMA buffer (half-words, or bytes if built with
+                                  NP32_CFG_DMA_BYTE_BUFFER), which holds the raw PWM information to output to the LED
+                                  data in pin of the LED array this instance represents. */
 
     volatile uint8_t DMA_Busy_Flag; /**< Busy flag for the DMA. 0 = Ready, 1 = Busy. */
 
-    int8_t (* StartDMA_Call)(uint16_t *buf, uint16_t len); /**< Function delegate for starting the DMA stream from the
-                                                                given buffer with the given length. */
+    int8_t (* StartDMA_Call)(NP32_DMA_t *buf, uint16_t len); /**< Function delegate for starting the DMA stream from
+                                                                  the given buffer with the given length (count of
+                                                                  buffer entries). For the SPI encodings, the buffer
+                                                                  is a byte stream (MSB first) and the length is given
+                                                                  in bytes. */
+
+    uint8_t Encoding; /**< The encoding of the transmitted bits, one of NP32_ENCODING_PWM (default), NP32_ENCODING_SPI3 or
+                           NP32_ENCODING_SPI4. With the SPI encodings, the DMA stream has to feed the data register of a
+                           SPI peripheral (byte frames, MSB first, MOSI idle low) instead of a timer compare
+                           register. Has to be set before calling \ref NP32_Init. */
+
+    const NP32_Timing_t *Timing; /**< The timing profile of the PWM encoding. If NULL (default), the compile-time profile
+                                      is used, which is the fastest. Otherwise, the compare values and the reset length
+                                      get taken from the given profile, which has to stay valid as long as the instance
+                                      is initialised. The reset length also applies to the SPI encodings. Has to be set
+                                      before calling \ref NP32_Init. */
+
+    uint8_t Format; /**< The pixel format of the LEDs, one of NP32_FORMAT_GRB (default), NP32_FORMAT_RGB,
+                         NP32_FORMAT_BRG, NP32_FORMAT_GRBW or NP32_FORMAT_GRB16. Determines the order and count of the
+                         bytes sent per LED, and so the size of the DMA buffer. Has to be set before calling
+                         \ref NP32_Init. */
+
+    void (* _Encoder)(NP32_Instance_t *handle, uint8_t *dst, uint16_t first, uint16_t count); /**< The encoder of the
+        encoding and pixel format of this instance: Encodes count LEDs from index first of the colour buffer to dst. */
+
+    uint8_t _Unit_Bytes; /**< The size of a single DMA transfer unit in bytes. */
+
+    uint8_t _LED_Bytes; /**< The count of DMA buffer bytes needed for the data of a single LED. */
+
+    uint16_t _Reset_Bytes; /**< The count of DMA buffer bytes needed for the reset periods. */
+
+    void (* FrameComplete_Call)(NP32_Instance_t *handle); /**< Optional function delegate, which gets called (from the
+                                                               DMA-complete interrupt) as soon as a frame including its
+                                                               reset periods has been transmitted and the LEDs latched
+                                                               the new colours. May be NULL. */
+
+    void (* _FrameDone_Hook)(NP32_Instance_t *handle); /**< Internal delegate of the module owning this instance (see
+                                                            \ref NP32_Group_Init), which gets called (from the
+                                                            DMA-complete interrupt) before FrameComplete_Call. May be
+                                                            NULL. */
+
+    void *_FrameDone_Ctx; /**< The context of _FrameDone_Hook. */
+
+    volatile uint8_t _Frame_Queued; /**< Set if a frame was queued by \ref NP32_UpdateAsync and has to be started as
+                                         soon as the DMA stream of the current frame completes. */
+
+    uint16_t Stream_Chunk_LEDs; /**< If set to 0 (default), the whole frame gets encoded into a DMA buffer holding all
+                                     LEDs of this instance. If non-zero, the instance operates in streaming mode: The
+                                     DMA buffer is a ring of 2 * Stream_Chunk_LEDs LEDs, which has to be transmitted by
+                                     a circular DMA stream. Each half of the ring gets re-encoded from the colour
+                                     buffer just in time by \ref NP32_DMAHalfComplete_Callback and
+                                     \ref NP32_DMAComplete_Callback. This keeps the DMA memory constant regardless of
+                                     the LED count. */
+
+    int8_t (* StopDMA_Call)(void); /**< Function delegate for stopping the circular DMA stream. Only needed (and
+                                        mandatory) in streaming mode. */
+
+    volatile uint32_t Stream_Underrun_Count; /**< Count of DMA ring half notifications, which were received out of
+                                                  order in streaming mode. A non-zero value means that the encoder fell
+                                                  behind the DMA stream (e.g. due to interrupt latency) and corrupted
+                                                  frames were transmitted. */
+
+    uint16_t _Stream_LED_Pos; /**< Streaming mode: The index of the next LED to encode into the ring. */
+
+    uint16_t _Stream_Reset_Left; /**< Streaming mode: The count of reset bytes still to be encoded into the ring. */
+
+    uint8_t _Stream_Live_Halves; /**< Streaming mode: The count of ring halves holding frame data (or reset periods),
+                                      which have not been transmitted yet. */
+
+    uint8_t _Stream_Next_Half; /**< Streaming mode: The ring half (0 or 1), whose completion is expected next. */
+
+    uint16_t _Dirty_Low; /**< The lowest index of the LEDs, which changed since the last encode of the DMA buffer. */
+
+    uint16_t _Dirty_High; /**< The highest index of the LEDs, which changed since the last encode of the DMA buffer. If
+                               lower than _Dirty_Low, no LED changed. */
+
+    uint8_t _Encoded_Disable_Flag; /**< The state of LED_Disable_Flag at the last encode of the DMA buffer. */
+
+    uint16_t _Stale_Low; /**< The lowest index of the LEDs, whose data in the DMA buffer got overwritten by the reset
+                              periods of a prefix update and has to be re-encoded before being transmitted. */
+
+    uint16_t _Stale_High; /**< The highest index of the stale LEDs. If lower than _Stale_Low, no LED is stale. */
+
+    uint8_t _Brightness; /**< The global brightness (0 to 255) applied by the colour correction. */
+
+    const uint8_t *_Gamma_Table; /**< The gamma correction table applied by the colour correction. NULL = linear. */
+
+    struct __NP32_RGB _White_Balance; /**< The scale factors (0 to 255) of the channels applied by the colour
+                                           correction. */
+
+    uint8_t *_Col_LUT; /**< The active colour correction table (3 * 256 bytes: R, G, B), which maps the colour buffer
+                            values to the sent values. Combines brightness, gamma and white balance. NULL if no
+                            correction is set. */
+
+    uint8_t *_Col_LUT_Buffer; /**< The memory of the colour correction table. Kept while the correction is neutral. */
+
+    uint16_t _Ring_Offset; /**< The index of LED 0 in the colour buffer. Rotating and shifting the LEDs only moves this
+                                offset, LED i is stored at index (i + _Ring_Offset) % LED_Count. */
+
+    struct __NP32_RGB *_Back_Buffer; /**< The back colour buffer, if double buffering is enabled (see
+                                          \ref NP32_Commit). Otherwise NULL. */
+
+    struct __NP32_RGB *_Alloc_Col_Buffer; /**< The colour buffer allocated by \ref NP32_Init. NULL if not allocated by
+                                               the library. */
+
+    struct __NP32_RGB *_Alloc_Back_Buffer; /**< The back colour buffer allocated by \ref NP32_EnableDoubleBuffer.
+                                                NULL if not allocated by the library. */
+
+    uint8_t _Static_Flags; /**< Marks the buffers, which are owned by the caller (see \ref NP32_InitStatic) and must not
+                                be freed. */
+
+    struct __NP32_RGB16 *_Dither_Buffer; /**< The high-precision colour buffer, if temporal dithering is enabled (see
+                                              \ref NP32_EnableDither). Otherwise NULL. */
+
+    uint8_t *_Dither_Err; /**< The quantisation errors (3 bytes per LED: R, G, B), which get carried over to the next
+                               frame by the temporal dithering. */
+
+    struct __NP32_RGB16 *_Alloc_Dither_Buffer; /**< The memory of the dithering buffers allocated by
+                                                    \ref NP32_EnableDither. NULL if not allocated by the library. */
+
+    uint32_t _Power_Sum[3]; /**< The running sums of the R, G and B values of the colour buffer, kept up to date by the
+                                 setters while the power limiter is enabled (see \ref NP32_SetPowerLimit). */
+
+    uint32_t _Power_Back_Sum[3]; /**< The sums of the R, G and B values of the back buffer, which get counted by the
+                                      commit (see \ref NP32_Commit) and swapped with _Power_Sum. */
+
+    uint32_t _Power_Budget_mA; /**< The current budget of the power limiter in mA. 0 = power limiter disabled. */
+
+    uint16_t _Power_Channel_uA; /**< The current of a single channel at full intensity in µA. */
+
+    uint16_t _Power_Idle_uA; /**< The quiescent current of a single LED in µA. */
+
+    uint8_t _Power_Scale; /**< The scale factor (0 to 255) applied to the brightness by the power limiter. */
+
+#if defined(NP32_CFG_STATS)
+    struct __NP32_Stats _Stats; /**< The statistics of the hot path. */
+
+    uint32_t _Stats_Frame_Start; /**< The timestamp of the start of the last frame. */
+#endif
 };
 
 typedef struct __NP32_RGB        NP32_RGB_t;
 typedef struct __NP32_HSV        NP32_HSV_t;
-typedef struct __NP32_Instance   NP32_Instance_t;
+typedef struct __NP32_RGB16      NP32_RGB16_t;
+
+/**
+ * \brief Gamma correction table for a gamma of 2.2 (see \ref NP32_SetGamma).
+ */
+extern const uint8_t NP32_Gamma_2_2[256];
 
 /**
  * \brief Initialises the provided \ref NP32_Instance_t and allocates the needed memory for the instance. This function
@@ -112,7 +581,33 @@ typedef struct __NP32_Instance   NP32_Instance_t;
 int8_t NP32_Init(NP32_Instance_t *handle);
 
 /**
- * \brief Deinitialises the given NP32 instance and frees up the memory allocated by its buffers.
+ * \brief Initialises the provided \ref NP32_Instance_t like \ref NP32_Init, but with buffers provided by the caller
+ *        instead of allocating them on the heap (see also \ref NP32_DEFINE_INSTANCE). No function of the library
+ *        allocates memory for an instance initialised this way, if a colour correction table is provided.
+ * \param handle The instance to initialise.
+ * \param col_buf The colour buffer, which has to hold LED_Count entries.
+ * \param dma_buf The DMA buffer, which has to be word-aligned and reachable by the DMA.
+ * \param dma_buf_entries The size of the DMA buffer in entries. Has to be at least \ref NP32_GetDMABufEntries (e.g.
+ *                        \ref NP32_DMA_BUF_ENTRIES or \ref NP32_DMA_BUF_ENTRIES_FMT).
+ * \param col_lut Optional memory for the colour correction table (\ref NP32_COL_LUT_SIZE bytes). If NULL, the table
+ *                gets allocated on the heap as soon as a colour correction is set.
+ * \return The status. If -1, then an error occurred while executing this function (e.g. DMA buffer too small). If 0,
+ *         the function terminated successfully.
+ */
+int8_t NP32_InitStatic(NP32_Instance_t *handle, NP32_RGB_t *col_buf, NP32_DMA_t *dma_buf, uint32_t dma_buf_entries,
+                       uint8_t *col_lut);
+
+/**
+ * \brief Gets the size of the DMA buffer needed by the given (not yet initialised) instance. The LED count, the
+ *        encoding, the timing profile and the streaming mode of the instance have to be set.
+ * \param handle The instance.
+ * \return The size of the DMA buffer in entries, or 0 if the configuration of the instance is not valid.
+ */
+uint32_t NP32_GetDMABufEntries(NP32_Instance_t *handle);
+
+/**
+ * \brief Deinitialises the given NP32 instance and frees up the memory allocated by its buffers. Buffers provided by the
+ *        caller (see \ref NP32_InitStatic) do not get freed.
  * \param handle The instance to de-init.
  */
 void NP32_DeInit(NP32_Instance_t *handle);
@@ -120,13 +615,40 @@ void NP32_DeInit(NP32_Instance_t *handle);
 /**
  * \brief This function updates the neopixel / WS2812 LED array, specified by the NP32 instance given to this function,
  *        to the current state of the LED colour buffer. This function recalculates the DMA buffer from the current LED
- *        colour buffer and intiates a DMA write to the corresponding PWM peripheral / GPIO pin.
+ *        colour buffer and intiates a DMA write to the corresponding PWM peripheral / GPIO pin. Only the LEDs, which
+ *        changed since the last update, get re-encoded (see \ref NP32_MarkDirty).
  * \param handle The instance which represents the neopixel / WS2812 LED array to update.
  * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
  *         successfully.
  */
 int8_t NP32_Update(NP32_Instance_t *handle);
 
+/**
+ * \brief Non-blocking variant of \ref NP32_Update. If the DMA stream is idle, the frame gets encoded and started right
+ *        away. Otherwise the frame gets queued and is encoded and started from \ref NP32_DMAComplete_Callback as soon
+ *        as the current frame has been transmitted. Queuing multiple frames during a single transmission results in
+ *        a single update, which shows the state of the colour buffer at the time the queued frame gets encoded.
+ *        \ref NP32_Instance_t::FrameComplete_Call can be used to get notified when the frame has been latched.
+ * \param handle The instance which represents the neopixel / WS2812 LED array to update.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the frame has been started.
+ *         If 1, the DMA stream was busy and the frame has been queued.
+ * \note As the queued frame gets encoded in the DMA-complete interrupt, the colour buffer should not be changed until
+ *       the queued frame has been started, unless a torn frame is acceptable.
+ */
+int8_t NP32_UpdateAsync(NP32_Instance_t *handle);
+
+/**
+ * \brief Marks the span of LEDs as changed, so it gets re-encoded at the next \ref NP32_Update. The setter functions
+ *        of this library do this on their own, this function only has to be called after writing to
+ *        \ref NP32_Instance_t::LED_Col_Buffer directly.
+ * \param handle The instance of the LEDs.
+ * \param lower_bound The lower bound index of the changed LEDs.
+ * \param higher_bound The higher bound index of the changed LEDs. Has to be greater or equal than lower_bound.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_MarkDirty(NP32_Instance_t *handle, uint16_t lower_bound, uint16_t higher_bound);
+
 /**
  * \brief Callback function for letting the library know, that the DMA stream of the previous DMA buffer is complete.
  *        This function should normally be called from the DMA-complete interrupt of the underlying HAL.
@@ -134,6 +656,15 @@ int8_t NP32_Update(NP32_Instance_t *handle);
  */
 void NP32_DMAComplete_Callback(NP32_Instance_t *handle);
 
+/**
+ * \brief Callback function for letting the library know, that the DMA stream has transmitted the first half of the DMA
+ *        ring buffer. This function is only needed in streaming mode (see \ref NP32_Instance_t::Stream_Chunk_LEDs) and
+ *        should normally be called from the DMA-half-transfer interrupt of the underlying HAL. In streaming mode,
+ *        \ref NP32_DMAComplete_Callback signals the completion of the second half of the ring.
+ * \param handle The instance, of which the DMA stream completed the first half of the ring.
+ */
+void NP32_DMAHalfComplete_Callback(NP32_Instance_t *handle);
+
 /**
  * \brief Function to convert from a HSV colour value to a RGB colour value.
  * \param hsv The HSV value to convert.
@@ -142,6 +673,40 @@ void NP32_DMAComplete_Callback(NP32_Instance_t *handle);
  */
 void NP32_HSV_To_RGB(NP32_HSV_t hsv, NP32_RGB_t *rgb);
 
+/**
+ * \brief Function to convert from a full-scale HSV colour value to a RGB colour value. Unlike \ref NP32_HSV_To_RGB, the
+ *        hue ranges from 0 to 1535 (see \ref NP32_HSV8_HUE_STEPS, greater values wrap around) and the saturation and
+ *        value use the full range of 0 to 255. The conversion is division-free (fixed-point).
+ * \param hsv The full-scale HSV value to convert.
+ * \param rgb The pointer to the RGB value to write the converted value into.
+ */
+void NP32_HSV8_To_RGB(NP32_HSV_t hsv, NP32_RGB_t *rgb);
+
+/**
+ * \brief Converts an array of full-scale HSV colour values (see \ref NP32_HSV8_To_RGB) to RGB colour values.
+ * \param hsv The HSV values to convert.
+ * \param rgb The array to write the converted values into. May be a colour buffer of an instance (see
+ *            \ref NP32_MarkDirty).
+ * \param count The count of values to convert.
+ */
+void NP32_HSV8_To_RGB_Array(const NP32_HSV_t *hsv, NP32_RGB_t *rgb, uint16_t count);
+
+/**
+ * \brief Computes a timing profile from the timer clock and the target bit period, high times and reset time (see
+ *        \ref NP32_TIMING_INIT). Can be used for running LEDs at their maximum tolerated bit rate and with a trimmed
+ *        reset time.
+ * \param timing The timing profile to compute.
+ * \param tim_clk_hz The clock frequency of the timer in Hz.
+ * \param bit_ns The period of a single bit in nanoseconds.
+ * \param t0h_ns The high time of a 0 bit in nanoseconds.
+ * \param t1h_ns The high time of a 1 bit in nanoseconds.
+ * \param reset_ns The minimum reset (latch) time in nanoseconds.
+ * \return The status. If -1, then the resulting profile is not valid (e.g. high times not within the bit period or
+ *         compare values not fitting into the DMA buffer entries). If 0, the function terminated successfully.
+ */
+int8_t NP32_Timing_Compute(NP32_Timing_t *timing, uint32_t tim_clk_hz, uint32_t bit_ns, uint32_t t0h_ns,
+                           uint32_t t1h_ns, uint32_t reset_ns);
+
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 /**
@@ -208,6 +773,39 @@ int8_t NP32_SetLEDSpan_RGB(NP32_Instance_t *handle, uint16_t lower_bound, uint16
  */
 int8_t NP32_SetLEDSpan_HSV(NP32_Instance_t *handle, uint16_t lower_bound, uint16_t higher_bound, NP32_HSV_t hsv);
 
+/**
+ * \brief Fills a span of LEDs of the given instance with a rainbow: The hue advances evenly from LED to LED, the
+ *        saturation and value stay constant (full-scale HSV, see \ref NP32_HSV8_To_RGB).
+ * \param handle The instance of the LEDs.
+ * \param lower_bound The lower bound index of the span of LEDs to fill.
+ * \param higher_bound The higher bound index of the span of LEDs to fill. It is necessary that this parameter is
+ *                     greater or equal than the lower_bound parameter.
+ * \param hue_start The hue of the LED at lower_bound (0 to 1535).
+ * \param hue_range The hue covered by the whole span. \ref NP32_HSV8_HUE_STEPS spreads the colour wheel over the span
+ *                  once, greater values repeat it.
+ * \param s The saturation of all LEDs in the span (0 to 255).
+ * \param v The value (brightness) of all LEDs in the span (0 to 255).
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_SetLEDSpan_Rainbow(NP32_Instance_t *handle, uint16_t lower_bound, uint16_t higher_bound, uint16_t hue_start,
+                               uint16_t hue_range, uint8_t s, uint8_t v);
+
+/**
+ * \brief Fills a span of LEDs of the given instance with a gradient between two full-scale HSV colours (see
+ *        \ref NP32_HSV8_To_RGB). The hue takes the shorter way around the colour wheel.
+ * \param handle The instance of the LEDs.
+ * \param lower_bound The lower bound index of the span of LEDs to fill.
+ * \param higher_bound The higher bound index of the span of LEDs to fill. It is necessary that this parameter is
+ *                     greater or equal than the lower_bound parameter.
+ * \param from The colour of the LED at lower_bound.
+ * \param to The colour of the LED at higher_bound.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_SetLEDSpan_Gradient(NP32_Instance_t *handle, uint16_t lower_bound, uint16_t higher_bound, NP32_HSV_t from,
+                                NP32_HSV_t to);
+
 /**
  * \brief Sets the colour of all LEDs of the given instance to black (RGB 0,0,0).
  * \param handle The instance of the LEDs to clear.
@@ -219,7 +817,8 @@ int8_t NP32_ClearAllLEDs(NP32_Instance_t *handle);
 /**
  * \brief Shifts the whole LED colour buffer to the left. (Left means that the colour of LED x will be the previous
  *        colour of the LED x + 1). The gap, which is created by shifting all LEDs to the left will be filled with the
- *        colour black.
+ *        colour black. Only the start of the colour buffer ring gets moved and the gap gets cleared, the other colours
+ *        are not copied.
  * \param handle The instance of the LEDs to shift.
  * \param shift_amount The amount of spots to shift the LEDs.
  * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
@@ -230,7 +829,8 @@ int8_t NP32_ShiftLeft(NP32_Instance_t *handle, uint16_t shift_amount);
 /**
  * \brief Shifts the whole LED colour buffer to the right. (Right means that the colour of LED x will be the previous
  *        colour of the LED x - 1). The gap, which is created by shifting all LEDs to the right will be filled with the
- *        colour black.
+ *        colour black. Only the start of the colour buffer ring gets moved and the gap gets cleared, the other colours
+ *        are not copied.
  * \param handle The instance of the LEDs to shift.
  * \param shift_amount The amount of spots to shift the LEDs.
  * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
@@ -243,7 +843,7 @@ int8_t NP32_ShiftRight(NP32_Instance_t *handle, uint16_t shift_amount);
  *        colour of the LED x + 1). This function places the colours, which get shiftet out of bounds, at the end of the
  *        LED array. Therefore no colours are lost and there is no need for filling in gaps with colour black. This can
  *        be useful if the LEDs are arranged in a circle, because a rotate of the LED array will also rotate the colours
- *        on the circle of LEDs.
+ *        on the circle of LEDs. This only moves the start of the colour buffer ring, so it takes constant time.
  * \param handle The instance of the LEDs to rotate.
  * \param rotate_amount The amount of spots to roteate the LEDs.
  * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
@@ -252,11 +852,10 @@ int8_t NP32_ShiftRight(NP32_Instance_t *handle, uint16_t shift_amount);
 int8_t NP32_RotateLeft(NP32_Instance_t *handle, uint16_t rotate_amount);
 
 /**
- * \brief Rotates the whole LED colour buffer to the left. (Left means that the colour of LED x will be the previous
- *        colour of the LED x + 1). This function places the colours, which get shiftet out of bounds, at the end of the
- *        LED array. Therefore no colours are lost and there is no need for filling in gaps with colour black. This can
- *        be useful if the LEDs are arranged in a circle, because a rotate of the LED array will also rotate the colours
- *        on the circle of LEDs.
+ * \brief Rotates the whole LED colour buffer to the right. (Right means that the colour of LED x will be the previous
+ *        colour of the LED x - 1). This function places the colours, which get shiftet out of bounds, at the start of
+ *        the LED array. Therefore no colours are lost and there is no need for filling in gaps with colour black. This
+ *        only moves the start of the colour buffer ring, so it takes constant time.
  * \param handle The instance of the LEDs to rotate.
  * \param rotate_amount The amount of spots to roteate the LEDs.
  * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
@@ -264,5 +863,234 @@ int8_t NP32_RotateLeft(NP32_Instance_t *handle, uint16_t rotate_amount);
  */
 int8_t NP32_RotateRight(NP32_Instance_t *handle, uint16_t rotate_amount);
 
+/**
+ * \brief Gets the colour of the specified LED from the colour buffer (taking a rotated or shifted buffer into account).
+ * \param handle The instance the LED belongs to.
+ * \param led_index The index of the LED in the data chain.
+ * \param rgb The pointer to write the colour of the LED into.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_GetLED_RGB(NP32_Instance_t *handle, uint16_t led_index, NP32_RGB_t *rgb);
+
+/**
+ * \brief Rearranges the colour buffer of the given instance in place, so the colour of LED i is stored at
+ *        LED_Col_Buffer[i] again. Rotating and shifting the LEDs only moves the start of the colour buffer, which is a
+ *        ring, so this has to be called before accessing \ref NP32_Instance_t::LED_Col_Buffer directly.
+ * \param handle The instance of the LEDs.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_Normalize(NP32_Instance_t *handle);
+
+/**
+ * \brief Copies an array of colours into a range of LEDs of the given instance (memcpy speed, one bounds check).
+ * \param handle The instance of the LEDs.
+ * \param first The index of the first LED to set.
+ * \param rgb The new colours. Can also be a packed array of RGB bytes (3 bytes per LED).
+ * \param count The count of LEDs to set. first + count must not exceed the LED count.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_SetLEDs_RGB(NP32_Instance_t *handle, uint16_t first, const NP32_RGB_t *rgb, uint16_t count);
+
+/**
+ * \brief Copies a packed array of GRB bytes (the order the LEDs receive them, 3 bytes per LED) into a range of LEDs of
+ *        the given instance.
+ * \param handle The instance of the LEDs.
+ * \param first The index of the first LED to set.
+ * \param grb The new colours as GRB bytes.
+ * \param count The count of LEDs to set. first + count must not exceed the LED count.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_SetLEDs_GRB(NP32_Instance_t *handle, uint16_t first, const uint8_t *grb, uint16_t count);
+
+/**
+ * \brief Replaces the colour buffer of the given instance by a frame owned by the caller, without copying. All LEDs get
+ *        re-encoded at the next update.
+ * \param handle The instance of the LEDs.
+ * \param frame The frame (LED_Count colours), which has to stay valid until it gets replaced or the instance gets
+ *              de-initialised. The buffer allocated by \ref NP32_Init is kept and freed by \ref NP32_DeInit.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_AttachFrame(NP32_Instance_t *handle, NP32_RGB_t *frame);
+
+/**
+ * \brief Enables double buffering for the given instance: The next frame gets drawn into the back buffer (see
+ *        \ref NP32_GetBackBuffer), while the current one gets encoded and transmitted from the colour buffer (front
+ *        buffer). \ref NP32_Commit swaps both buffers.
+ * \param handle The instance of the LEDs.
+ * \param back_buf The back buffer (LED_Count colours) provided by the caller. If NULL, the back buffer gets allocated
+ *                 on the heap.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_EnableDoubleBuffer(NP32_Instance_t *handle, NP32_RGB_t *back_buf);
+
+/**
+ * \brief Gets the back buffer of the given instance, which holds the colour of LED i at index i. Writing to it does not
+ *        affect the LEDs until \ref NP32_Commit.
+ * \param handle The instance of the LEDs.
+ * \return The back buffer, or NULL if double buffering is not enabled.
+ */
+NP32_RGB_t *NP32_GetBackBuffer(NP32_Instance_t *handle);
+
+/**
+ * \brief Swaps the front and the back buffer of the given instance (constant time), so the back buffer gets sent at the
+ *        next update. Afterwards, the back buffer holds an older frame and has to be redrawn completely. While the
+ *        power limiter is enabled, the commit counts the channel sums of the back buffer (O(LED count)).
+ * \param handle The instance of the LEDs.
+ * \return The status. If -1, then double buffering is not enabled. If 0, the function terminated successfully.
+ * \note In streaming mode, the colour buffer gets read while the frame is transmitted, so a commit during the
+ *       transmission results in a torn frame.
+ */
+int8_t NP32_Commit(NP32_Instance_t *handle);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Sets the global brightness of the given instance. The brightness gets applied while encoding the colours into
+ *        the DMA buffer, the colour buffer stays untouched. A change only rebuilds the colour correction table of the
+ *        instance and re-encodes all LEDs at the next update.
+ * \param handle The instance to set the brightness of.
+ * \param brightness The brightness from 0 (off) to 255 (full, default).
+ * \return The status. If -1, then the colour correction table could not be allocated. If 0, the function terminated
+ *         successfully.
+ * \note Any colour correction (brightness, gamma or white balance) needs a table of \ref NP32_COL_LUT_SIZE bytes,
+ *       which gets allocated on the heap at the first correction, unless it was provided to \ref NP32_InitStatic.
+ *       Without correction (the default), no table is used.
+ */
+int8_t NP32_SetBrightness(NP32_Instance_t *handle, uint8_t brightness);
+
+/**
+ * \brief Sets the gamma correction of the given instance. The gamma correction gets applied while encoding, before the
+ *        brightness and the white balance (see \ref NP32_SetBrightness).
+ * \param handle The instance to set the gamma correction of.
+ * \param gamma_table The gamma correction table (256 entries, e.g. \ref NP32_Gamma_2_2), which maps the colour buffer
+ *                    values to linear output values. Has to stay valid as long as it is set. NULL = no gamma
+ *                    correction (default).
+ * \return The status. If -1, then the colour correction table could not be allocated. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_SetGamma(NP32_Instance_t *handle, const uint8_t *gamma_table);
+
+/**
+ * \brief Sets the white balance of the given instance: A scale factor per channel, which gets applied while encoding
+ *        together with the brightness (see \ref NP32_SetBrightness).
+ * \param handle The instance to set the white balance of.
+ * \param white_balance The scale factors of the red, green and blue channels from 0 to 255 (default: 255, 255, 255).
+ * \return The status. If -1, then the colour correction table could not be allocated. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_SetWhiteBalance(NP32_Instance_t *handle, NP32_RGB_t white_balance);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Enables the temporal dithering for the given instance: The LEDs get sent from a high-precision colour buffer
+ *        (16 bits per channel) instead of the colour buffer. The encoder quantises each value to 8 bits and carries the
+ *        remainder over to the next frame, so the LEDs show the fraction on average over successive frames. This
+ *        gives smooth fades at low brightness, as long as the frames get sent at a high refresh rate. All LEDs get
+ *        re-encoded at every update. The brightness and the white balance get applied with the full precision, the
+ *        gamma correction does not get applied (the application writes the output values). With the 16-bit pixel
+ *        format (\ref NP32_FORMAT_GRB16), the values get sent with their full 16 bits (scaled by the brightness and
+ *        the white balance) instead of being dithered.
+ * \param handle The instance.
+ * \param buf The high-precision colour buffer (LED_Count entries, not rotated: LED i is stored at index i). If NULL,
+ *            the buffers get allocated (and freed by \ref NP32_DeInit) and the high-precision colour buffer gets
+ *            initialised from the colour buffer.
+ * \param err_buf The quantisation error buffer (\ref NP32_DITHER_ERR_SIZE bytes). Has to be provided together with
+ *                buf, ignored if buf is NULL.
+ * \return The status. If -1, then an error occurred while executing this function (e.g. the buffers could not be
+ *         allocated). If 0, the function terminated successfully.
+ */
+int8_t NP32_EnableDither(NP32_Instance_t *handle, NP32_RGB16_t *buf, uint8_t *err_buf);
+
+/**
+ * \brief Disables the temporal dithering for the given instance, the LEDs get sent from the colour buffer again.
+ *        Allocated dithering buffers are kept until \ref NP32_DeInit.
+ * \param handle The instance.
+ */
+void NP32_DisableDither(NP32_Instance_t *handle);
+
+/**
+ * \brief Gets the high-precision colour buffer of the given instance, e.g. for rendering a frame into it directly.
+ * \param handle The instance.
+ * \return The high-precision colour buffer, or NULL if the temporal dithering is not enabled.
+ */
+NP32_RGB16_t *NP32_GetDitherBuffer(NP32_Instance_t *handle);
+
+/**
+ * \brief Sets the high-precision colour of the given LED (see \ref NP32_EnableDither).
+ * \param handle The instance.
+ * \param led_index The index of the LED.
+ * \param rgb The high-precision colour.
+ * \return The status. If -1, then an error occurred while executing this function (e.g. dithering not enabled). If 0,
+ *         the function terminated successfully.
+ */
+int8_t NP32_SetLED_RGB16(NP32_Instance_t *handle, uint16_t led_index, NP32_RGB16_t rgb);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Sets the power limiter of the given instance: The estimated current of each frame gets capped to the given
+ *        budget by scaling down the brightness applied while encoding (see \ref NP32_SetBrightness). The estimate is
+ *        based on running sums of the R, G and B values of the colour buffer, which the setters keep up to date
+ *        (O(1) per LED, O(span) per span), so no extra pass over the colour buffer is needed at the update. Changes
+ *        outside of the setters get counted right away by the call reporting them (\ref NP32_Commit counts the back
+ *        buffer, \ref NP32_AttachFrame and \ref NP32_MarkDirty the colour buffer, O(LED count) each), never by the
+ *        update, which may run in the DMA-complete interrupt. Only with temporal dithering, the estimate gets counted
+ *        from the high-precision colour buffer at every update.
+ *        The estimate includes the brightness and the white balance, but not the gamma correction (which lowers
+ *        the values), so it is conservative for the usual gamma tables. A change of the scale factor re-encodes all
+ *        LEDs; the scale gets lowered right away, but only raised by steps of at least 4 (or back to full), so a
+ *        frame hovering around the budget does not re-encode the whole strip at every update.
+ * \param handle The instance.
+ * \param budget_mA The current budget in mA (e.g. the share of the power supply of the strip). 0 = disable the power
+ *                  limiter (default).
+ * \param channel_uA The current of a single channel at full intensity in µA (e.g. \ref NP32_WS2812_CHANNEL_UA).
+ * \param idle_uA The quiescent current of a single LED in µA (e.g. \ref NP32_WS2812_IDLE_UA).
+ * \return The status. If -1, then an error occurred while executing this function (e.g. the colour correction table
+ *         could not be allocated). If 0, the function terminated successfully.
+ * \note The limiter needs the colour correction table (see \ref NP32_SetBrightness), which gets allocated here, so the
+ *       update does not allocate memory. The strips of a parallel group (see neopixel32_parallel.h) are not limited.
+ */
+int8_t NP32_SetPowerLimit(NP32_Instance_t *handle, uint32_t budget_mA, uint16_t channel_uA, uint16_t idle_uA);
+
+/**
+ * \brief Gets the estimated current of the current frame of the given instance before limiting (see
+ *        \ref NP32_SetPowerLimit). If the power limiter is disabled, the colour buffer gets counted.
+ * \param handle The instance.
+ * \return The estimated current in mA (rounded up). Uses the currents of the power limiter, or the WS2812 defaults
+ *         (\ref NP32_WS2812_CHANNEL_UA, \ref NP32_WS2812_IDLE_UA) if it was never set.
+ */
+uint32_t NP32_GetPowerEstimate(NP32_Instance_t *handle);
+
+/**
+ * \brief Gets the scale factor applied to the brightness by the power limiter at the last update.
+ * \param handle The instance.
+ * \return The scale factor from 0 to 255 (full brightness).
+ */
+uint8_t NP32_GetPowerScale(NP32_Instance_t *handle);
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+/**
+ * \brief Gets the statistics of the given instance. The statistics get updated from the DMA interrupts, so the copy
+ *        may mix the values of two successive frames.
+ * \param handle The instance.
+ * \param stats The structure to copy the statistics to.
+ * \return The status. If -1, then the library was built without NP32_CFG_STATS. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_GetStats(NP32_Instance_t *handle, NP32_Stats_t *stats);
+
+/**
+ * \brief Resets the statistics of the given instance to 0. The statistics also get reset by \ref NP32_Init.
+ * \param handle The instance.
+ */
+void NP32_ResetStats(NP32_Instance_t *handle);
 
 #endif // __NEOPIXEL32_H
\ No newline at end of file
@@ -0,0 +1,141 @@
+/*******************************************************************************
+* \file neopixel32_anim.h
+* \date 16.10.2026
+********************************************************************************
+* \author Johannes Berndorfer (berndoJ)
+* \copyright Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+********************************************************************************
+* \brief Frame-paced animation scheduler for libneopixel32: Runs the effects of
+*        an instance on a fixed timestep and renders each frame into the back
+*        buffer, while the previous frame is transmitted.
+*
+* \paragraph impl_anim Implementation
+*        The application calls \ref NP32_Anim_Run from its main loop. As soon as
+*        the next timestep is due, all effects render into the back buffer of
+*        the instance, which then gets committed and queued with
+*        \ref NP32_UpdateAsync. The queued frame gets started by the
+*        DMA-complete interrupt, so the DMA completion is the vertical sync of
+*        the animation. While a frame is still queued, no further frame gets
+*        rendered; timesteps, which passed in the meantime, get coalesced into
+*        the next frame (the effects get the current tick, so the animation
+*        speed stays the same). Only the LEDs from the first to the last LED
+*        rendered by the effects in this or the previous frame get cleared and
+*        re-encoded, all other LEDs are kept from the front buffer. Between
+*        the frames, the application can sleep for \ref NP32_Anim_TimeToNext
+*        microseconds instead of spinning.
+*
+* \paragraph dep_anim Dependencies
+*        The following dependencies are needed for this module:
+*          - libc *(stdint.h)*
+*******************************************************************************/
+
+#if !defined(__NEOPIXEL32_ANIM_H)
+#define __NEOPIXEL32_ANIM_H
+
+#include <stdint.h>
+#include "neopixel32.h"
+
+/**
+ * \brief The maximum count of effects of a single animation.
+ */
+#define NP32_ANIM_MAX_EFFECTS           8U
+
+typedef struct __NP32_Effect NP32_Effect_t;
+typedef struct __NP32_Anim NP32_Anim_t;
+
+/**
+ * \brief Represents an effect, which renders a span of LEDs.
+ */
+struct __NP32_Effect
+{
+    void (* Render_Call)(NP32_Effect_t *effect, NP32_RGB_t *leds, uint16_t count, uint32_t tick); /**< Function
+        delegate rendering the effect: Writes the colours of the span (count LEDs, leds[0] is LED First_LED) for the
+        given tick (the count of timesteps since \ref NP32_Anim_Init). The span is black before the first effect
+        renders, effects added later draw on top of earlier ones. */
+
+    void *Context; /**< Optional pointer to the state of the effect. Not used by the library. */
+
+    uint16_t First_LED; /**< The index of the first LED of the span rendered by this effect. */
+
+    uint16_t LED_Count; /**< The count of LEDs of the span. 0 = up to the last LED of the instance. */
+
+    uint8_t Enabled; /**< The effect gets rendered only if set to 1. */
+};
+
+/**
+ * \brief Represents the animation of a single instance.
+ */
+struct __NP32_Anim
+{
+    NP32_Instance_t *Instance; /**< The (initialised) instance to animate. */
+
+    uint32_t Tick_Period_us; /**< The period of a timestep in microseconds. Frames get rendered at most once per
+                                  timestep. A period shorter than the frame time gives the maximum refresh rate. */
+
+    uint32_t (* GetTime_Call)(void); /**< Function delegate returning a monotonic time in microseconds (may wrap
+                                          around). */
+
+    uint32_t Tick; /**< The tick of the last rendered frame (count of timesteps since \ref NP32_Anim_Init). */
+
+    uint32_t Frames_Rendered; /**< The count of frames rendered. */
+
+    uint32_t Ticks_Coalesced; /**< The count of timesteps, which were not rendered as a frame on their own, because the
+                                   previous frame was still pending. */
+
+    NP32_Effect_t *_Effects[NP32_ANIM_MAX_EFFECTS]; /**< The effects, in render order. */
+
+    uint8_t _Effect_Count; /**< The count of effects. */
+
+    uint32_t _Next_Tick; /**< The tick of the next timestep. */
+
+    uint32_t _Next_Time; /**< The time, at which the next timestep is due. */
+
+    uint16_t _Span_Low; /**< The lowest index of the LEDs rendered by the effects in the previous frame. */
+
+    uint16_t _Span_High; /**< The highest index of the LEDs rendered in the previous frame. If lower than _Span_Low, no
+                              LED was rendered. */
+};
+
+/**
+ * \brief Initialises the given animation. Enables double buffering for the instance, if not enabled yet (allocating the
+ *        back buffer, see \ref NP32_EnableDoubleBuffer). The first frame is due right away.
+ * \param anim The animation to initialise. The instance, the tick period and the time delegate have to be set.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_Anim_Init(NP32_Anim_t *anim);
+
+/**
+ * \brief Adds an effect to the given animation. The effect is rendered after all effects added before.
+ * \param anim The animation.
+ * \param effect The effect to add, which has to stay valid as long as it is added.
+ * \return The status. If -1, then an error occurred while executing this function (e.g. too many effects). If 0, the
+ *         function terminated successfully.
+ */
+int8_t NP32_Anim_AddEffect(NP32_Anim_t *anim, NP32_Effect_t *effect);
+
+/**
+ * \brief Removes an effect from the given animation.
+ * \param anim The animation.
+ * \param effect The effect to remove.
+ * \return The status. If -1, then the effect was not found. If 0, the function terminated successfully.
+ */
+int8_t NP32_Anim_RemoveEffect(NP32_Anim_t *anim, NP32_Effect_t *effect);
+
+/**
+ * \brief Runs the given animation: If the next timestep is due and no frame is pending, renders all effects into the
+ *        back buffer, commits it and queues it for transmission. Does not block.
+ * \param anim The animation to run.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, no frame was due (or the
+ *         previous frame is still pending). If 1, a frame has been rendered and started or queued.
+ */
+int8_t NP32_Anim_Run(NP32_Anim_t *anim);
+
+/**
+ * \brief Gets the time until the next timestep of the given animation is due, e.g. for sleeping until then.
+ * \param anim The animation.
+ * \return The time until the next timestep in microseconds. 0 if it is already due.
+ */
+uint32_t NP32_Anim_TimeToNext(NP32_Anim_t *anim);
+
+#endif // __NEOPIXEL32_ANIM_H
@@ -0,0 +1,145 @@
+/*******************************************************************************
+* \file neopixel32_blend.h
+* \date 16.10.2026
+********************************************************************************
+* \author Johannes Berndorfer (berndoJ)
+* \copyright Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+********************************************************************************
+* \brief Blending operations on colour buffers for libneopixel32: Fading,
+*        crossfades, saturating addition and compositing of layers.
+*
+* \paragraph impl_blend Implementation
+*        All operations apply the same factor to every channel, so the colour
+*        buffers get processed as plain byte streams (3 bytes per LED),
+*        several bytes at once:
+*          - Host builds: SSE2 or NEON, 16 bytes per instruction.
+*          - Otherwise: SWAR on 32-bit words, which computes two bytes per
+*            multiplication in 16-bit lanes.
+*          - Cortex-M4 / M7 (DSP extension): Only the saturating addition is
+*            accelerated (UQADD8, 4 bytes per instruction). Scaling and
+*            interpolation use the SWAR code, as the DSP extension has no
+*            8-bit multiplication (UHADD8 only halves, UQSUB8 only subtracts).
+*        Defining NP32_CFG_BLEND_NO_SIMD forces the portable code.
+*        The blend factors range from 0 to 255, where 255 is the full factor
+*        (e.g. scaling by 255 keeps the colour). The functions operating on an
+*        instance take the LED indices like the setters (respecting the ring
+*        offset) and mark the processed LEDs dirty. They are not available
+*        while temporal dithering is enabled, as the colour buffer does not
+*        hold the sent colours then.
+*
+* \paragraph dep_blend Dependencies
+*        The following dependencies are needed for this module:
+*          - libc *(stdint.h, string.h)*
+*******************************************************************************/
+
+#if !defined(__NEOPIXEL32_BLEND_H)
+#define __NEOPIXEL32_BLEND_H
+
+#include <stdint.h>
+#include "neopixel32.h"
+
+/**
+ * \brief Layer mode: The layer gets blended over the LEDs with its alpha (crossfade).
+ */
+#define NP32_BLEND_OVER                 0U
+
+/**
+ * \brief Layer mode: The layer gets scaled by its alpha and added to the LEDs (saturating).
+ */
+#define NP32_BLEND_ADD                  1U
+
+typedef struct __NP32_Layer NP32_Layer_t;
+
+/**
+ * \brief Represents a layer, which gets composited onto the LEDs of an instance by \ref NP32_Blend_Composite.
+ */
+struct __NP32_Layer
+{
+    const NP32_RGB_t *Pixels; /**< The colours of the layer (one per composited LED). */
+
+    uint8_t Alpha; /**< The opacity (NP32_BLEND_OVER) or intensity (NP32_BLEND_ADD) of the layer. 0 = the layer is
+                        skipped, 255 = full. */
+
+    uint8_t Mode; /**< The blend mode, NP32_BLEND_OVER or NP32_BLEND_ADD. */
+};
+
+/**
+ * \brief Scales the colours of a buffer (e.g. for fading to black): dst = src * scale / 255.
+ * \param dst The output buffer. May be src.
+ * \param src The input buffer.
+ * \param count The count of colours.
+ * \param scale The scale factor. 255 = keep, 0 = black.
+ */
+void NP32_BlendBuf_Scale(NP32_RGB_t *dst, const NP32_RGB_t *src, uint16_t count, uint8_t scale);
+
+/**
+ * \brief Interpolates linearly between two buffers: dst = a + (b - a) * alpha / 255.
+ * \param dst The output buffer. May be a or b.
+ * \param a The first buffer (alpha = 0).
+ * \param b The second buffer (alpha = 255).
+ * \param count The count of colours.
+ * \param alpha The blend factor.
+ */
+void NP32_BlendBuf_Lerp(NP32_RGB_t *dst, const NP32_RGB_t *a, const NP32_RGB_t *b, uint16_t count, uint8_t alpha);
+
+/**
+ * \brief Adds two buffers, saturating each channel at 255: dst = min(a + b, 255).
+ * \param dst The output buffer. May be a or b.
+ * \param a The first buffer.
+ * \param b The second buffer.
+ * \param count The count of colours.
+ */
+void NP32_BlendBuf_Add(NP32_RGB_t *dst, const NP32_RGB_t *a, const NP32_RGB_t *b, uint16_t count);
+
+/**
+ * \brief Scales the colours of a span of LEDs of the given instance (see \ref NP32_BlendBuf_Scale).
+ * \param handle The instance.
+ * \param first The index of the first LED.
+ * \param count The count of LEDs.
+ * \param scale The scale factor. 255 = keep, 0 = black.
+ * \return The status. If -1, then an error occurred while executing this function (e.g. the span exceeds the LED
+ *         count or dithering is enabled). If 0, the function terminated successfully.
+ */
+int8_t NP32_Blend_Scale(NP32_Instance_t *handle, uint16_t first, uint16_t count, uint8_t scale);
+
+/**
+ * \brief Sets a span of LEDs of the given instance to the linear interpolation between two buffers (e.g. for
+ *        crossfading between two frames, see \ref NP32_BlendBuf_Lerp).
+ * \param handle The instance.
+ * \param first The index of the first LED.
+ * \param a The colours of the first buffer (a[0] belongs to LED first).
+ * \param b The colours of the second buffer.
+ * \param count The count of LEDs.
+ * \param alpha The blend factor.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_Blend_Lerp(NP32_Instance_t *handle, uint16_t first, const NP32_RGB_t *a, const NP32_RGB_t *b,
+                       uint16_t count, uint8_t alpha);
+
+/**
+ * \brief Adds a buffer to a span of LEDs of the given instance, saturating each channel at 255.
+ * \param handle The instance.
+ * \param first The index of the first LED.
+ * \param src The colours to add (src[0] belongs to LED first).
+ * \param count The count of LEDs.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_Blend_Add(NP32_Instance_t *handle, uint16_t first, const NP32_RGB_t *src, uint16_t count);
+
+/**
+ * \brief Composites layers onto a span of LEDs of the given instance, in the given order (the current colours of the
+ *        LEDs are the bottom layer).
+ * \param handle The instance.
+ * \param first The index of the first LED.
+ * \param layers The layers.
+ * \param layer_count The count of layers.
+ * \param count The count of LEDs.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_Blend_Composite(NP32_Instance_t *handle, uint16_t first, const NP32_Layer_t *layers, uint8_t layer_count,
+                            uint16_t count);
+
+#endif // __NEOPIXEL32_BLEND_H
@@ -0,0 +1,103 @@
+/*******************************************************************************
+* \file neopixel32_group.h
+* \date 16.10.2026
+********************************************************************************
+* \author Johannes Berndorfer (berndoJ)
+* \copyright Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+********************************************************************************
+* \brief Synchronous update of several libneopixel32 instances, each driven by
+*        its own DMA channel.
+*
+* \paragraph impl_grp Implementation
+*        \ref NP32_Group_Update waits until the previous frame of the group has
+*        been transmitted by all members, then encodes and starts the members
+*        one after another, the longest strip first. While a member transmits,
+*        the next one gets encoded, so the frame time of the group is close to
+*        the frame time of its longest strip (plus the encode time of the
+*        others, if they are longer than the transmission). The completion of
+*        the members gets tracked through \ref NP32_DMAComplete_Callback: Each
+*        member marks its slot of the group when its frame is done, the last
+*        one signals the frame of the group as done. A slot is only written by
+*        the interrupt of its member, so the tracking does not need atomic
+*        operations. The DMA-complete interrupts of the members have to run at
+*        the same priority though (so they do not preempt each other), else
+*        \ref NP32_Group_t::FrameComplete_Call could be called twice.
+*
+* \paragraph dep_grp Dependencies
+*        The following dependencies are needed for this module:
+*          - libc *(stdint.h)*
+*******************************************************************************/
+
+#if !defined(__NEOPIXEL32_GROUP_H)
+#define __NEOPIXEL32_GROUP_H
+
+#include <stdint.h>
+#include "neopixel32.h"
+
+/**
+ * \brief The maximum count of instances of a single group.
+ */
+#define NP32_GROUP_MAX_INSTANCES        8U
+
+typedef struct __NP32_Group NP32_Group_t;
+
+/**
+ * \brief Represents a group of instances, whose frames get started and completed together.
+ */
+struct __NP32_Group
+{
+    NP32_Instance_t *Instances[NP32_GROUP_MAX_INSTANCES]; /**< The member instances. The members have to be initialised
+                                                               (by \ref NP32_Init) before the group and must not be
+                                                               updated on their own while being members. The
+                                                               FrameComplete_Call of a member still gets called for its
+                                                               own frames. */
+
+    uint8_t Instance_Count; /**< The count of member instances. */
+
+    void (* FrameComplete_Call)(NP32_Group_t *group); /**< Optional function delegate, which gets called (from the
+                                                           DMA-complete interrupt of the last member) as soon as all
+                                                           members transmitted their frame. May be NULL. */
+
+    volatile uint32_t Frames_Done; /**< The count of frames transmitted by all members. */
+
+    uint8_t _Order[NP32_GROUP_MAX_INSTANCES]; /**< The indices of the members in update order (longest first). */
+
+    volatile uint8_t _Frame; /**< The sequence number of the current frame of the group. */
+
+    volatile uint8_t _Done[NP32_GROUP_MAX_INSTANCES]; /**< The sequence number of the last frame transmitted by each
+                                                           member. The frame of the group is done if all of them equal
+                                                           _Frame. */
+};
+
+/**
+ * \brief Initialises the given group: Attaches the group to the DMA-complete notifications of its members.
+ * \param group The group to initialise. The members and their count have to be set.
+ * \return The status. If -1, then an error occurred while executing this function (e.g. a member is not initialised or
+ *         already belongs to a group). If 0, the function terminated successfully.
+ */
+int8_t NP32_Group_Init(NP32_Group_t *group);
+
+/**
+ * \brief Deinitialises the given group: Waits for the current frame and detaches the group from its members.
+ * \param group The group to de-init.
+ */
+void NP32_Group_DeInit(NP32_Group_t *group);
+
+/**
+ * \brief Updates all members of the given group: Waits for the previous frame of the group, then encodes and starts
+ *        the DMA streams of all members back to back. If a member fails to update, it and the members after it are
+ *        skipped, so the group does not stay busy.
+ * \param group The group to update.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_Group_Update(NP32_Group_t *group);
+
+/**
+ * \brief Checks whether the current frame of the given group is still being transmitted by any member.
+ * \param group The group.
+ * \return 1 if a member is still transmitting, otherwise 0.
+ */
+uint8_t NP32_Group_IsBusy(NP32_Group_t *group);
+
+#endif // __NEOPIXEL32_GROUP_H
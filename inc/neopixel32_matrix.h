@@ -0,0 +1,192 @@
+/*******************************************************************************
+* \file neopixel32_matrix.h
+* \date 16.10.2026
+********************************************************************************
+* \author Johannes Berndorfer (berndoJ)
+* \copyright Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+********************************************************************************
+* \brief 2D matrix view over a libneopixel32 instance: Addresses the LEDs of a
+*        (serpentine, rotated or tiled) LED matrix by x and y coordinates.
+*
+* \paragraph impl_mat Implementation
+*        The layout of the matrix (wiring order, tiles, rotation) gets compiled
+*        into a map at \ref NP32_Matrix_Init, which holds the LED index of each
+*        pixel (row by row, as seen by the application). All drawing functions
+*        look up the LED indices in this map, so no function computes the
+*        layout per pixel. The physical layout is described by the panel size
+*        (Width x Height), the tile size and the layout flags:
+*          - The LEDs of a tile are wired row by row starting at its top-left
+*            corner (or column by column with \ref NP32_MATRIX_COLUMNS). With
+*            \ref NP32_MATRIX_SERPENTINE, every other row (column) runs in the
+*            opposite direction.
+*          - The tiles are chained row by row starting at the top-left tile
+*            (with \ref NP32_MATRIX_TILES_SERPENTINE, every other row of tiles
+*            runs from right to left).
+*        The rotation turns the view of the application clockwise in steps of
+*        90 degrees, e.g. for a panel mounted upside down.
+*
+* \paragraph dep_mat Dependencies
+*        The following dependencies are needed for this module:
+*          - libc *(stdint.h)*
+*******************************************************************************/
+
+#if !defined(__NEOPIXEL32_MATRIX_H)
+#define __NEOPIXEL32_MATRIX_H
+
+#include <stdint.h>
+#include "neopixel32.h"
+
+/**
+ * \brief Layout flag: Every other row (or column) of a tile runs in the opposite direction.
+ */
+#define NP32_MATRIX_SERPENTINE          0x01U
+
+/**
+ * \brief Layout flag: The LEDs of a tile are wired column by column (top to bottom) instead of row by row.
+ */
+#define NP32_MATRIX_COLUMNS             0x02U
+
+/**
+ * \brief Layout flag: Every other row of tiles is chained from right to left.
+ */
+#define NP32_MATRIX_TILES_SERPENTINE    0x04U
+
+/**
+ * \brief The size of the map of a matrix with the given panel size in entries (see \ref NP32_Matrix_Init).
+ */
+#define NP32_MATRIX_MAP_SIZE(w,h)       ((uint32_t) (w) * (uint32_t) (h))
+
+typedef struct __NP32_Matrix NP32_Matrix_t;
+
+/**
+ * \brief Represents a 2D matrix view over the LEDs of an instance.
+ */
+struct __NP32_Matrix
+{
+    NP32_Instance_t *Instance; /**< The (initialised) instance holding the LEDs of the matrix. The matrix uses the LEDs
+                                    0 to Width * Height - 1. */
+
+    uint16_t Width; /**< The width of the panel (in its wiring orientation) in pixels. */
+
+    uint16_t Height; /**< The height of the panel (in its wiring orientation) in pixels. */
+
+    uint16_t Tile_Width; /**< The width of a tile in pixels. 0 = the panel is a single tile. Has to divide Width. */
+
+    uint16_t Tile_Height; /**< The height of a tile in pixels. 0 = the panel is a single tile. Has to divide Height. */
+
+    uint8_t Layout; /**< The layout flags (NP32_MATRIX_SERPENTINE, NP32_MATRIX_COLUMNS, NP32_MATRIX_TILES_SERPENTINE). */
+
+    uint8_t Rotation; /**< The rotation of the view in steps of 90 degrees clockwise (0 to 3). */
+
+    uint16_t View_Width; /**< The width of the view of the application. Gets set by \ref NP32_Matrix_Init (Width, or
+                              Height if rotated by 90 or 270 degrees). */
+
+    uint16_t View_Height; /**< The height of the view of the application. Gets set by \ref NP32_Matrix_Init. */
+
+    uint16_t *_Map; /**< The LED index of each pixel of the view, row by row. */
+
+    uint16_t *_Alloc_Map; /**< The map allocated by \ref NP32_Matrix_Init. NULL if provided by the caller. */
+};
+
+/**
+ * \brief Initialises the given matrix: Compiles its layout into the map.
+ * \param matrix The matrix to initialise. The instance, the panel size, the tile size, the layout and the rotation have
+ *               to be set.
+ * \param map Optional memory for the map (\ref NP32_MATRIX_MAP_SIZE entries). If NULL, the map gets allocated.
+ * \return The status. If -1, then an error occurred while executing this function (e.g. the matrix has more pixels
+ *         than the instance has LEDs). If 0, the function terminated successfully.
+ */
+int8_t NP32_Matrix_Init(NP32_Matrix_t *matrix, uint16_t *map);
+
+/**
+ * \brief Deinitialises the given matrix and frees its map, unless provided by the caller.
+ * \param matrix The matrix to de-init.
+ */
+void NP32_Matrix_DeInit(NP32_Matrix_t *matrix);
+
+/**
+ * \brief Gets the index of the LED at the given coordinates.
+ * \param matrix The matrix.
+ * \param x The x coordinate (column of the view).
+ * \param y The y coordinate (row of the view).
+ * \return The LED index, or 0xFFFF if the coordinates are outside of the view or the matrix is not initialised.
+ */
+uint16_t NP32_Matrix_Index(NP32_Matrix_t *matrix, uint16_t x, uint16_t y);
+
+/**
+ * \brief Sets the colour of the pixel at the given coordinates.
+ * \param matrix The matrix.
+ * \param x The x coordinate.
+ * \param y The y coordinate.
+ * \param rgb The colour to set.
+ * \return The status. If -1, then the coordinates are outside of the view. If 0, the function terminated successfully.
+ */
+int8_t NP32_Matrix_SetPixel(NP32_Matrix_t *matrix, uint16_t x, uint16_t y, NP32_RGB_t rgb);
+
+/**
+ * \brief Gets the colour of the pixel at the given coordinates.
+ * \param matrix The matrix.
+ * \param x The x coordinate.
+ * \param y The y coordinate.
+ * \param rgb Pointer to the output colour.
+ * \return The status. If -1, then the coordinates are outside of the view. If 0, the function terminated successfully.
+ */
+int8_t NP32_Matrix_GetPixel(NP32_Matrix_t *matrix, uint16_t x, uint16_t y, NP32_RGB_t *rgb);
+
+/**
+ * \brief Fills a rectangle of the view with a colour. The rectangle gets clipped to the view.
+ * \param matrix The matrix.
+ * \param x The x coordinate of the top-left corner (may be negative).
+ * \param y The y coordinate of the top-left corner (may be negative).
+ * \param w The width of the rectangle.
+ * \param h The height of the rectangle.
+ * \param rgb The colour to fill.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_Matrix_FillRect(NP32_Matrix_t *matrix, int16_t x, int16_t y, uint16_t w, uint16_t h, NP32_RGB_t rgb);
+
+/**
+ * \brief Copies a bitmap (e.g. a sprite or a glyph) into the view. The bitmap gets clipped to the view.
+ * \param matrix The matrix.
+ * \param x The x coordinate of the top-left corner of the bitmap (may be negative).
+ * \param y The y coordinate of the top-left corner of the bitmap (may be negative).
+ * \param bitmap The pixels of the bitmap, row by row.
+ * \param w The width of the bitmap.
+ * \param h The height of the bitmap.
+ * \param key Optional transparent colour: Pixels of the bitmap with this colour do not get copied. May be NULL.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_Matrix_Blit(NP32_Matrix_t *matrix, int16_t x, int16_t y, const NP32_RGB_t *bitmap, uint16_t w, uint16_t h,
+                        const NP32_RGB_t *key);
+
+/**
+ * \brief Scrolls a rectangle of the view by the given amount of pixels. The pixels scrolled in get set to the fill
+ *        colour. The rectangle has to lie within the view.
+ * \param matrix The matrix.
+ * \param x The x coordinate of the top-left corner of the rectangle.
+ * \param y The y coordinate of the top-left corner of the rectangle.
+ * \param w The width of the rectangle.
+ * \param h The height of the rectangle.
+ * \param dx The horizontal amount (positive = to the right).
+ * \param dy The vertical amount (positive = down).
+ * \param fill The colour of the pixels scrolled in.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_Matrix_ScrollRect(NP32_Matrix_t *matrix, uint16_t x, uint16_t y, uint16_t w, uint16_t h, int16_t dx,
+                              int16_t dy, NP32_RGB_t fill);
+
+/**
+ * \brief Scrolls the whole view by the given amount of pixels (see \ref NP32_Matrix_ScrollRect).
+ * \param matrix The matrix.
+ * \param dx The horizontal amount (positive = to the right).
+ * \param dy The vertical amount (positive = down).
+ * \param fill The colour of the pixels scrolled in.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_Matrix_Scroll(NP32_Matrix_t *matrix, int16_t dx, int16_t dy, NP32_RGB_t fill);
+
+#endif // __NEOPIXEL32_MATRIX_H
@@ -0,0 +1,116 @@
+/*******************************************************************************
+* \file neopixel32_parallel.h
+* \date 16.10.2026
+********************************************************************************
+* \author Johannes Berndorfer (berndoJ)
+* \copyright Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+********************************************************************************
+* \brief Parallel output of up to 16 neopixel / WS2812 LED strips, driven by the
+*        pins of a single GPIO port through one DMA stream.
+*
+* \paragraph impl_par Implementation
+*        The colour buffers of all member instances get transposed into bit
+*        planes: One half-word per transmitted bit period, whose bit k belongs
+*        to the strip on GPIO pin k. A plane holds the mask of all strips,
+*        which send a 0 bit in this period. The HAL is expected to drive the
+*        port with a timer and three DMA requests per period:
+*          - Update event: Write \ref NP32_Parallel_t::Pin_Mask to BSRR (all
+*            data lines high).
+*          - Compare at \ref NP32_WS2812_0_TIME: Write the plane to BRR (the
+*            lines of 0 bits go low).
+*          - Compare at \ref NP32_WS2812_1_TIME: Write
+*            \ref NP32_Parallel_t::Pin_Mask to BRR (all lines low).
+*        Only the plane stream comes from the buffer of this module. After the
+*        transfer completed, the HAL has to keep the data lines low for at
+*        least the reset time before calling
+*        \ref NP32_Parallel_DMAComplete_Callback (e.g. by stopping the set
+*        request and letting the timer run for \ref NP32_WS2812_ZERO_PERIODS
+*        more periods).
+*
+* \paragraph dep_par Dependencies
+*        The following dependencies are needed for this module:
+*          - libc *(stdint.h)*
+*******************************************************************************/
+
+#if !defined(__NEOPIXEL32_PARALLEL_H)
+#define __NEOPIXEL32_PARALLEL_H
+
+#include <stdint.h>
+#include "neopixel32.h"
+
+/**
+ * \brief The maximum count of strips driven by a single parallel group (= the width of a plane).
+ */
+#define NP32_PARALLEL_MAX_STRIPS        16U
+
+typedef struct __NP32_Parallel NP32_Parallel_t;
+
+/**
+ * \brief Represents a group of LED strips, which are driven in parallel by the pins 0 to Strip_Count - 1 of a single
+ *        GPIO port. The frame time of the group is the frame time of its longest strip.
+ */
+struct __NP32_Parallel
+{
+    NP32_Instance_t *Strips[NP32_PARALLEL_MAX_STRIPS]; /**< The member instances. Strip k is driven by GPIO pin k. The
+                                                            members only need their LED count to be set, they must not
+                                                            be initialised by \ref NP32_Init. Their colour buffers get
+                                                            allocated by \ref NP32_Parallel_Init. All members have to
+                                                            use the GRB pixel format. */
+
+    uint8_t Strip_Count; /**< The count of member instances. */
+
+    uint16_t Pin_Mask; /**< The mask of all GPIO pins driven by this group. Gets set by \ref NP32_Parallel_Init. */
+
+    uint16_t _LED_Count; /**< The LED count of the longest member strip. */
+
+    uint16_t *_Plane_Buffer; /**< The DMA buffer holding 24 bit planes per LED. */
+
+    volatile uint8_t DMA_Busy_Flag; /**< Busy flag for the DMA. 0 = Ready, 1 = Busy. */
+
+    int8_t (* StartDMA_Call)(uint16_t *buf, uint16_t len); /**< Function delegate for starting the DMA stream of the
+                                                                given bit planes with the given length (count of
+                                                                planes). */
+
+    void (* FrameComplete_Call)(NP32_Parallel_t *group); /**< Optional function delegate, which gets called as soon as
+                                                              a frame has been transmitted. May be NULL. */
+};
+
+/**
+ * \brief Initialises the given parallel group: Allocates the colour buffers of all member instances and the plane
+ *        buffer of the group.
+ * \param group The group to initialise. The member instances, the strip count and the DMA delegate have to be set.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_Parallel_Init(NP32_Parallel_t *group);
+
+/**
+ * \brief Deinitialises the given parallel group and frees the colour buffers of its members and its plane buffer.
+ * \param group The group to de-init.
+ */
+void NP32_Parallel_DeInit(NP32_Parallel_t *group);
+
+/**
+ * \brief Updates all strips of the group to the current state of their colour buffers. Transposes the changed LEDs of
+ *        all members into the plane buffer and starts the DMA stream. Waits for the previous frame to complete.
+ * \param group The group to update.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_Parallel_Update(NP32_Parallel_t *group);
+
+/**
+ * \brief Callback function for letting the library know, that the DMA stream of the group (including the reset time)
+ *        is complete.
+ * \param group The group, of which the DMA stream completed.
+ */
+void NP32_Parallel_DMAComplete_Callback(NP32_Parallel_t *group);
+
+/**
+ * \brief Transposes an 8x8 bit matrix. Bit (7 - c) of in[r] becomes bit (7 - r) of out[c].
+ * \param in The 8 rows of the matrix.
+ * \param out The 8 rows of the transposed matrix.
+ */
+void NP32_Parallel_Transpose8(const uint8_t *in, uint8_t *out);
+
+#endif // __NEOPIXEL32_PARALLEL_H
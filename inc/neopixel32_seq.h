@@ -0,0 +1,144 @@
+/*******************************************************************************
+* \file neopixel32_seq.h
+* \date 16.10.2026
+********************************************************************************
+* \author Johannes Berndorfer (berndoJ)
+* \copyright Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+********************************************************************************
+* \brief Compressed frame sequences for libneopixel32: Plays pre-rendered shows
+*        stored in flash, coded as keyframes and run-length coded changes.
+*
+* \paragraph impl_seq Implementation
+*        A sequence starts with a header of \ref NP32_SEQ_HEADER_SIZE bytes
+*        (magic "NP32", version, reserved byte, LED count, frame count), which
+*        is followed by the frames. All multi-byte values are little endian.
+*        A frame starts with a flags byte (\ref NP32_SEQ_KEYFRAME) and its
+*        duration in milliseconds (2 bytes), followed by the codes, which walk
+*        the LEDs from index 0:
+*          - 0x00: End of the frame. The remaining LEDs are unchanged.
+*          - 0x01 to 0x7F: Skip 1 to 127 unchanged LEDs.
+*          - 0x80 | (n - 1): n (1 to 64) literal colours follow (R, G, B).
+*          - 0xC0 | (n - 1): The next n (1 to 64) LEDs get the single colour,
+*            which follows (R, G, B).
+*        A keyframe does not skip any LED, so it does not depend on the
+*        previous frame. The first frame of a sequence is always a keyframe.
+*        \ref NP32_Seq_Seek jumps to a frame by decoding from the last keyframe
+*        before it, so more keyframes make seeking faster at the cost of size.
+*        \ref NP32_Seq_Next decodes a frame straight into the colour buffer of
+*        the instance and marks only the span of the changed LEDs dirty, so the
+*        decode and encode cost of a frame is proportional to its change.
+*        \ref NP32_Seq_EncodeFrame codes a frame against its predecessor (e.g.
+*        by a host tool, see tools/np32_seqenc.c).
+*
+* \paragraph dep_seq Dependencies
+*        The following dependencies are needed for this module:
+*          - libc *(stdint.h)*
+*******************************************************************************/
+
+#if !defined(__NEOPIXEL32_SEQ_H)
+#define __NEOPIXEL32_SEQ_H
+
+#include <stdint.h>
+#include "neopixel32.h"
+
+/**
+ * \brief The size of the header of a sequence in bytes.
+ */
+#define NP32_SEQ_HEADER_SIZE            10U
+
+/**
+ * \brief The version of the sequence format.
+ */
+#define NP32_SEQ_VERSION                1U
+
+/**
+ * \brief Frame flag: The frame is a keyframe (does not depend on the previous frame).
+ */
+#define NP32_SEQ_KEYFRAME               0x01U
+
+/**
+ * \brief The worst case size of a coded frame of the given count of LEDs in bytes (frame header, literal codes and the
+ *        end code).
+ */
+#define NP32_SEQ_FRAME_MAX_SIZE(n)      (3UL + (3UL * (uint32_t) (n)) + (((uint32_t) (n) + 63UL) / 64UL) + 1UL)
+
+typedef struct __NP32_Seq NP32_Seq_t;
+
+/**
+ * \brief Represents the playback of a sequence on an instance.
+ */
+struct __NP32_Seq
+{
+    NP32_Instance_t *Instance; /**< The (initialised) instance to play the sequence on. */
+
+    const uint8_t *Data; /**< The sequence (header and frames), e.g. in flash. */
+
+    uint32_t Size; /**< The size of the sequence in bytes. */
+
+    uint16_t LED_Count; /**< The count of LEDs of the sequence. Gets set by \ref NP32_Seq_Init. */
+
+    uint16_t Frame_Count; /**< The count of frames of the sequence. Gets set by \ref NP32_Seq_Init. */
+
+    uint16_t Frame; /**< The index of the next frame to decode. */
+
+    uint16_t Duration_ms; /**< The duration of the last decoded frame in milliseconds. */
+
+    uint32_t _Pos; /**< The offset of the next frame in the data. */
+};
+
+/**
+ * \brief Initialises the given playback: Checks the header of the sequence and rewinds it.
+ * \param seq The playback to initialise. The instance, the data and its size have to be set.
+ * \return The status. If -1, then an error occurred while executing this function (e.g. the sequence has more LEDs than
+ *         the instance). If 0, the function terminated successfully.
+ */
+int8_t NP32_Seq_Init(NP32_Seq_t *seq);
+
+/**
+ * \brief Rewinds the given playback to the first frame.
+ * \param seq The playback.
+ */
+void NP32_Seq_Rewind(NP32_Seq_t *seq);
+
+/**
+ * \brief Decodes the next frame of the given playback into the colour buffer of the instance and marks the changed LEDs
+ *        dirty. The frame is applied to the colour buffer (not the back buffer), as it is a change to the previous
+ *        frame. The duration of the frame gets stored in \ref NP32_Seq_t::Duration_ms.
+ * \param seq The playback.
+ * \return The status. If -1, then the frame is corrupt (the LEDs decoded so far are kept). If 0, the end of the sequence
+ *         has been reached. If 1, a frame has been decoded.
+ */
+int8_t NP32_Seq_Next(NP32_Seq_t *seq);
+
+/**
+ * \brief Seeks the given playback to the given frame: Skips to the last keyframe up to the frame and decodes the frames
+ *        from there into the colour buffer of the instance, so the colour buffer holds the given frame. The next frame
+ *        to decode is the one after it.
+ * \param seq The playback.
+ * \param frame The index of the frame.
+ * \return The status. If -1, then an error occurred while executing this function (e.g. the index is out of range or
+ *         a frame is corrupt). If 0, the function terminated successfully.
+ */
+int8_t NP32_Seq_Seek(NP32_Seq_t *seq, uint16_t frame);
+
+/**
+ * \brief Writes the header of a sequence.
+ * \param out The output (\ref NP32_SEQ_HEADER_SIZE bytes).
+ * \param led_count The count of LEDs of each frame.
+ * \param frame_count The count of frames.
+ */
+void NP32_Seq_EncodeHeader(uint8_t *out, uint16_t led_count, uint16_t frame_count);
+
+/**
+ * \brief Codes a frame against the previous frame.
+ * \param prev The previous frame. If NULL, the frame gets coded as a keyframe.
+ * \param cur The frame to code.
+ * \param led_count The count of LEDs of the frame.
+ * \param duration_ms The duration of the frame in milliseconds.
+ * \param out The output, which has to hold \ref NP32_SEQ_FRAME_MAX_SIZE bytes.
+ * \return The size of the coded frame in bytes.
+ */
+uint32_t NP32_Seq_EncodeFrame(const NP32_RGB_t *prev, const NP32_RGB_t *cur, uint16_t led_count, uint16_t duration_ms,
+                              uint8_t *out);
+
+#endif // __NEOPIXEL32_SEQ_H
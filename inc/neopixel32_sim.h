@@ -0,0 +1,150 @@
+/*******************************************************************************
+* \file neopixel32_sim.h
+* \date 16.10.2026
+********************************************************************************
+* \author Johannes Berndorfer (berndoJ)
+* \copyright Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+********************************************************************************
+* \brief Simulated DMA / PWM backend for running libneopixel32 on a host (e.g.
+*        x86-64 Linux) machine. Only part of the host build.
+*
+* \paragraph dep_par Dependencies
+*        The following dependencies are needed for this module:
+*          - libc *(stdint.h)*
+*          - POSIX threads and clocks *(pthread.h, time.h)*
+*******************************************************************************/
+
+#if !defined(__NEOPIXEL32_SIM_H)
+#define __NEOPIXEL32_SIM_H
+
+#include <stdint.h>
+#include <pthread.h>
+#include "neopixel32.h"
+
+/**
+ * \brief The maximum count of instances, which can be attached to the simulated backend at the same time.
+ */
+#define NP32_SIM_MAX_CHANNELS           16U
+
+/**
+ * \brief The duration of a single timer period (transmitted bit) in nanoseconds. Derived from the timer period at a
+ *        timer clock of 72MHz.
+ */
+#define NP32_SIM_PERIOD_NS              (((NP32_WS2812_TIM_PERIOD + 1UL) * 1000000000UL) / 72000000UL)
+
+/**
+ * \brief State of the decoder, which turns a stream of compare values back into GRB bytes.
+ */
+struct __NP32_Sim_Decoder
+{
+    uint8_t *Out; /**< The buffer to write the decoded bytes to. */
+    uint32_t Out_Size; /**< The size of the output buffer in bytes. Further decoded bytes get dropped. */
+    uint32_t Out_Count; /**< The count of bytes decoded (including dropped ones). */
+    uint32_t Reset_Periods; /**< The count of consecutive reset (zero) periods seen at the end of the stream. */
+    uint16_t Threshold; /**< PWM encoding: Compare values above this threshold are 1 bits. Set to the midpoint between
+                             \ref NP32_WS2812_0_TIME and \ref NP32_WS2812_1_TIME by \ref NP32_Sim_Decoder_Reset. */
+    uint8_t _Byte; /**< The byte currently being decoded. */
+    uint8_t _Bits; /**< The count of bits already decoded into _Byte. */
+    uint8_t _Sym; /**< SPI encodings: The symbol currently being read. */
+    uint8_t _Sym_Bits; /**< SPI encodings: The count of bits already read into _Sym. */
+};
+
+/**
+ * \brief Represents a simulated DMA / PWM channel, which drives a single \ref NP32_Instance_t.
+ */
+struct __NP32_Sim
+{
+    NP32_Instance_t *Instance; /**< The instance driven by this channel. */
+
+    uint32_t Period_ns; /**< The duration of a single transmitted period (bit) in nanoseconds. Set to
+                             \ref NP32_SIM_PERIOD_NS by \ref NP32_Sim_Attach, can be changed afterwards (e.g. for
+                             instances with a timing profile). For the SPI encodings, the SPI clock is derived from
+                             this period. */
+
+    uint8_t *Frame_GRB; /**< The bytes decoded from the wire during the last frame, in the order they were sent (GRB
+                             for the default pixel format). */
+
+    uint32_t Frame_Len; /**< The count of bytes decoded during the last frame. */
+
+    volatile uint32_t Frames_Sent; /**< The count of frames transmitted by this channel. */
+
+    volatile uint32_t Underruns; /**< The count of ring halves in streaming mode, whose callback took longer than the
+                                      transmission of a half of the ring. The DMA stream of a real device would have
+                                      transmitted stale data in this case. */
+
+    uint64_t Max_Callback_ns; /**< The longest execution time of a DMA callback (i.e. the encoder) in nanoseconds. */
+
+    pthread_t _Thread; /**< The thread simulating the DMA stream. */
+    pthread_mutex_t _Lock; /**< Lock protecting the start / stop requests. */
+    pthread_cond_t _Cond; /**< Condition signalled on start / stop requests. */
+    NP32_DMA_t *_Buf; /**< The DMA buffer of the current transfer. */
+    uint16_t _Len; /**< The length of the current transfer. */
+    volatile uint8_t _Start; /**< Set if a transfer has been requested. */
+    volatile uint8_t _Stop; /**< Set if the circular transfer has been stopped. */
+    volatile uint8_t _Quit; /**< Set if the thread has to terminate. */
+};
+
+typedef struct __NP32_Sim_Decoder   NP32_Sim_Decoder_t;
+typedef struct __NP32_Sim           NP32_Sim_t;
+
+/**
+ * \brief Attaches the simulated backend to the given instance. This sets the DMA delegates of the instance and has to
+ *        be called after setting the LED count, the pixel format and the streaming mode of the instance, but before
+ *        \ref NP32_Init.
+ * \param sim The simulated channel to attach.
+ * \param handle The instance to drive.
+ * \return The status. If -1, then an error occurred while executing this function. If 0, the function terminated
+ *         successfully.
+ */
+int8_t NP32_Sim_Attach(NP32_Sim_t *sim, NP32_Instance_t *handle);
+
+/**
+ * \brief Detaches the simulated backend from its instance, stops the simulation thread and frees the capture buffer.
+ * \param sim The simulated channel to detach.
+ */
+void NP32_Sim_Detach(NP32_Sim_t *sim);
+
+/**
+ * \brief Waits until the simulated channel has transmitted the current frame (including queued frames).
+ * \param sim The simulated channel.
+ */
+void NP32_Sim_WaitIdle(NP32_Sim_t *sim);
+
+/**
+ * \brief The DMA start delegate of the simulated backend. Gets set by \ref NP32_Sim_Attach.
+ */
+int8_t NP32_Sim_StartDMA(NP32_DMA_t *buf, uint16_t len);
+
+/**
+ * \brief The DMA stop delegate of the simulated backend. Gets set by \ref NP32_Sim_Attach.
+ */
+int8_t NP32_Sim_StopDMA(void);
+
+/**
+ * \brief Resets the given decoder.
+ * \param dec The decoder to reset.
+ * \param out The buffer to write the decoded GRB bytes to.
+ * \param out_size The size of the output buffer in bytes.
+ */
+void NP32_Sim_Decoder_Reset(NP32_Sim_Decoder_t *dec, uint8_t *out, uint32_t out_size);
+
+/**
+ * \brief Feeds compare values into the decoder. A compare value of 0 is a reset period, compare values above the
+ *        threshold of the decoder are 1 bits, others are 0 bits.
+ * \param dec The decoder.
+ * \param buf The compare values.
+ * \param len The count of compare values.
+ */
+void NP32_Sim_Decode(NP32_Sim_Decoder_t *dec, const NP32_DMA_t *buf, uint32_t len);
+
+/**
+ * \brief Feeds a SPI byte stream (MSB first) into the decoder. A symbol of all zero bits is a reset period, otherwise
+ *        the second bit of each symbol is the data bit.
+ * \param dec The decoder.
+ * \param buf The SPI bytes.
+ * \param len The count of SPI bytes.
+ * \param symbol_bits The count of bits per symbol (3 or 4).
+ */
+void NP32_Sim_Decode_SPI(NP32_Sim_Decoder_t *dec, const uint8_t *buf, uint32_t len, uint8_t symbol_bits);
+
+#endif // __NEOPIXEL32_SIM_H
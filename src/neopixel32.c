@@ -2,14 +2,413 @@
 // Copyright (c) 2020 Johannes Berndorfer (berndoJ)
 
 #include "neopixel32.h"
+#include "neopixel32_priv.h"
 #include <stdlib.h>
+#include <string.h>
+#if defined(NP32_CFG_STATS) && !defined(NP32_CFG_STATS_TIME) && defined(NP32_CFG_HOST)
+#include <time.h>
+#endif
 
-static void _NP32_Recalc_DMA_Buf(NP32_Instance_t *handle);
+// The bulk copy functions rely on NP32_RGB_t being 3 packed bytes.
+typedef char _NP32_RGB_Size_Check[(sizeof(NP32_RGB_t) == 3) ? 1 : -1];
+
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+#error "The bit encoding table of libneopixel32 requires a little-endian target."
+#endif
+
+// Compare values of a single bit, widened for packing them into the words of the bit encoding table.
+#define _NP32_LUT_T(val,bit)        ((uint32_t) NP32_RESOLVE_BIT_TIME((val), (bit)))
+
+// One row of the bit encoding table: The compare values of bit 7 down to bit 0 of a byte, packed into words in the
+// order they are laid out in the (little-endian) DMA buffer.
+#if defined(NP32_CFG_DMA_BYTE_BUFFER)
+#define _NP32_LUT_WORDS             2
+#define _NP32_LUT_ROW(v)            { _NP32_LUT_T(v, 7) | (_NP32_LUT_T(v, 6) << 8) | (_NP32_LUT_T(v, 5) << 16) |     \
+                                          (_NP32_LUT_T(v, 4) << 24),                                                \
+                                      _NP32_LUT_T(v, 3) | (_NP32_LUT_T(v, 2) << 8) | (_NP32_LUT_T(v, 1) << 16) |     \
+                                          (_NP32_LUT_T(v, 0) << 24) }
+#define _NP32_PUT_BYTE(d,v)         do { const uint32_t *_r = _NP32_Bit_LUT[(v)];                                  \
+                                         (d)[0] = _r[0]; (d)[1] = _r[1]; (d) += 2; } while (0)
+#else
+#define _NP32_LUT_WORDS             4
+#define _NP32_LUT_ROW(v)            { _NP32_LUT_T(v, 7) | (_NP32_LUT_T(v, 6) << 16),                               \
+                                      _NP32_LUT_T(v, 5) | (_NP32_LUT_T(v, 4) << 16),                               \
+                                      _NP32_LUT_T(v, 3) | (_NP32_LUT_T(v, 2) << 16),                               \
+                                      _NP32_LUT_T(v, 1) | (_NP32_LUT_T(v, 0) << 16) }
+#define _NP32_PUT_BYTE(d,v)         do { const uint32_t *_r = _NP32_Bit_LUT[(v)];                                  \
+                                         (d)[0] = _r[0]; (d)[1] = _r[1]; (d)[2] = _r[2]; (d)[3] = _r[3];            \
+                                         (d) += 4; } while (0)
+#endif
+#define _NP32_LUT_ROWS_16(r,h)      r((h) + 0x0), r((h) + 0x1), r((h) + 0x2), r((h) + 0x3), r((h) + 0x4),           \
+                                    r((h) + 0x5), r((h) + 0x6), r((h) + 0x7), r((h) + 0x8), r((h) + 0x9),           \
+                                    r((h) + 0xA), r((h) + 0xB), r((h) + 0xC), r((h) + 0xD), r((h) + 0xE),           \
+                                    r((h) + 0xF)
+#define _NP32_LUT_ROWS_256(r)       _NP32_LUT_ROWS_16(r, 0x00), _NP32_LUT_ROWS_16(r, 0x10),                         \
+                                    _NP32_LUT_ROWS_16(r, 0x20), _NP32_LUT_ROWS_16(r, 0x30),                         \
+                                    _NP32_LUT_ROWS_16(r, 0x40), _NP32_LUT_ROWS_16(r, 0x50),                         \
+                                    _NP32_LUT_ROWS_16(r, 0x60), _NP32_LUT_ROWS_16(r, 0x70),                         \
+                                    _NP32_LUT_ROWS_16(r, 0x80), _NP32_LUT_ROWS_16(r, 0x90),                         \
+                                    _NP32_LUT_ROWS_16(r, 0xA0), _NP32_LUT_ROWS_16(r, 0xB0),                         \
+                                    _NP32_LUT_ROWS_16(r, 0xC0), _NP32_LUT_ROWS_16(r, 0xD0),                         \
+                                    _NP32_LUT_ROWS_16(r, 0xE0), _NP32_LUT_ROWS_16(r, 0xF0)
+
+// SPI symbols of a single bit: Bit 1 = 110 / 1110, bit 0 = 100 / 1000.
+#define _NP32_SPI3_SYM(val,bit)     ((((val) >> (bit)) & 0x01) ? 0x6UL : 0x4UL)
+#define _NP32_SPI4_SYM(val,bit)     ((((val) >> (bit)) & 0x01) ? 0xEUL : 0x8UL)
+
+// The 24 symbol bits of a byte in the 3-bit SPI encoding, MSB first.
+#define _NP32_SPI3_BITS(v)          ((_NP32_SPI3_SYM(v, 7) << 21) | (_NP32_SPI3_SYM(v, 6) << 18) |                  \
+                                     (_NP32_SPI3_SYM(v, 5) << 15) | (_NP32_SPI3_SYM(v, 4) << 12) |                  \
+                                     (_NP32_SPI3_SYM(v, 3) << 9) | (_NP32_SPI3_SYM(v, 2) << 6) |                    \
+                                     (_NP32_SPI3_SYM(v, 1) << 3) | _NP32_SPI3_SYM(v, 0))
+// Rows of the SPI symbol tables: The symbol bytes in the order they are sent (= the order in memory).
+#define _NP32_SPI3_ROW(v)           (((_NP32_SPI3_BITS(v) >> 16) & 0xFFUL) | (_NP32_SPI3_BITS(v) & 0xFF00UL) |      \
+                                     ((_NP32_SPI3_BITS(v) & 0xFFUL) << 16))
+#define _NP32_SPI4_ROW(v)           ((_NP32_SPI4_SYM(v, 7) << 4) | _NP32_SPI4_SYM(v, 6) |                           \
+                                     (_NP32_SPI4_SYM(v, 5) << 12) | (_NP32_SPI4_SYM(v, 4) << 8) |                   \
+                                     (_NP32_SPI4_SYM(v, 3) << 20) | (_NP32_SPI4_SYM(v, 2) << 16) |                  \
+                                     (_NP32_SPI4_SYM(v, 1) << 28) | (_NP32_SPI4_SYM(v, 0) << 24))
+
+/**
+ * \brief Flash-resident bit encoding table. Maps a colour byte to the 8 compare values of its bits (MSB first), so the
+ *        encoder writes a whole byte with a few word stores instead of resolving every bit on its own.
+ */
+static const uint32_t _NP32_Bit_LUT[256][_NP32_LUT_WORDS] = { _NP32_LUT_ROWS_256(_NP32_LUT_ROW) };
+
+/**
+ * \brief Flash-resident symbol tables of the SPI encodings. Map a colour byte to its 3 (3-bit symbols) or 4 (4-bit
+ *        symbols) SPI bytes, packed into a word in the order they are sent.
+ */
+static const uint32_t _NP32_SPI3_LUT[256] = { _NP32_LUT_ROWS_256(_NP32_SPI3_ROW) };
+static const uint32_t _NP32_SPI4_LUT[256] = { _NP32_LUT_ROWS_256(_NP32_SPI4_ROW) };
+
+// Encodes count LEDs from index first of the colour buffer to dst.
+typedef void (* _NP32_Encoder_t)(NP32_Instance_t *handle, uint8_t *dst, uint16_t first, uint16_t count);
+
+// Byte sequences of the pixel formats: Invoke put(v) for every byte sent to an LED of colour c, in the order they are
+// sent.
+#define _NP32_FMT_GRB(c,put)        put((c).G); put((c).R); put((c).B)
+#define _NP32_FMT_RGB(c,put)        put((c).R); put((c).G); put((c).B)
+#define _NP32_FMT_BRG(c,put)        put((c).B); put((c).R); put((c).G)
+#define _NP32_FMT_GRBW(c,put)       do { uint8_t _w = ((c).R < (c).G) ? (c).R : (c).G;                             \
+                                         if ((c).B < _w) _w = (c).B;                                                 \
+                                         put((uint8_t) ((c).G - _w)); put((uint8_t) ((c).R - _w));                   \
+                                         put((uint8_t) ((c).B - _w)); put(_w); } while (0)
+#define _NP32_FMT_GRB16(c,put)      put((c).G); put((c).G); put((c).R); put((c).R); put((c).B); put((c).B)
+// The same for a high-precision colour c (NP32_RGB16_t): 16 bits per channel, MSB first.
+#define _NP32_FMT_WIDE_GRB16(c,put) put((uint8_t) ((c).G >> 8)); put((uint8_t) (c).G);                             \
+                                    put((uint8_t) ((c).R >> 8)); put((uint8_t) (c).R);                             \
+                                    put((uint8_t) ((c).B >> 8)); put((uint8_t) (c).B)
+
+// Byte writers of the encodings, used as put of the pixel formats. The PWM encodings write to dst32, the 3-bit SPI
+// encoding (not word-aligned) writes to dst.
+#define _NP32_PUT_PWM(v)            _NP32_PUT_BYTE(dst32, (v))
+#if defined(NP32_CFG_DMA_BYTE_BUFFER)
+#define _NP32_PUT_PWM_Timing(v)     do { uint8_t _v = (v);                                                         \
+                                         dst32[0] = lut[_v >> 4][0]; dst32[1] = lut[_v & 0x0F][0];                   \
+                                         dst32 += 2; } while (0)
+#else
+#define _NP32_PUT_PWM_Timing(v)     do { uint8_t _v = (v);                                                         \
+                                         dst32[0] = lut[_v >> 4][0]; dst32[1] = lut[_v >> 4][1];                     \
+                                         dst32[2] = lut[_v & 0x0F][0]; dst32[3] = lut[_v & 0x0F][1];                 \
+                                         dst32 += 4; } while (0)
+#endif
+#define _NP32_PUT_SPI3(v)           do { uint32_t _s = _NP32_SPI3_LUT[(v)];                                        \
+                                         dst[0] = (uint8_t) _s; dst[1] = (uint8_t) (_s >> 8);                        \
+                                         dst[2] = (uint8_t) (_s >> 16); dst += 3; } while (0)
+#define _NP32_PUT_SPI4(v)           do { *dst32++ = _NP32_SPI4_LUT[(v)]; } while (0)
+
+// Local variables of the byte writers.
+#define _NP32_LOCALS_PWM            uint32_t *dst32 = (uint32_t *) dst;
+#define _NP32_LOCALS_PWM_Timing     uint32_t *dst32 = (uint32_t *) dst;                                            \
+                                    const uint32_t (*lut)[(4 * sizeof(NP32_DMA_t)) / 4] = handle->Timing->_LUT;
+#define _NP32_LOCALS_SPI3
+#define _NP32_LOCALS_SPI4           uint32_t *dst32 = (uint32_t *) dst;
+
+// Defines the encoder _NP32_Encode_<enc>_<fmt> of an encoding and a pixel format, so every combination gets its own
+// loop without any branches on the format or the encoding.
+#define _NP32_DEFINE_ENCODER(enc,fmt)                                                                               \
+    static void _NP32_Encode_##enc##_##fmt(NP32_Instance_t *handle, uint8_t *dst, uint16_t first, uint16_t count)   \
+    {                                                                                                               \
+        _NP32_LOCALS_##enc                                                                                          \
+        NP32_RGB_t curr_col;                                                                                        \
+        uint16_t i;                                                                                                 \
+                                                                                                                    \
+        for (i = first; i < first + count; i++)                                                                     \
+        {                                                                                                           \
+            /* Get the current LED color. In the LED disable mode, black gets sent to all LEDs. */                  \
+            curr_col = _NP32_Load_Col_Phys(handle, i);                                                              \
+            _NP32_FMT_##fmt(curr_col, _NP32_PUT_##enc);                                                             \
+        }                                                                                                           \
+    }
+
+// Defines the encoder _NP32_Encode_Dither_<enc>_<fmt> of the temporal dithering: Same as _NP32_DEFINE_ENCODER, but
+// the colours get quantised from the high-precision colour buffer (not rotated) in the same pass.
+#define _NP32_DEFINE_DITHER_ENCODER(enc,fmt)                                                                        \
+    static void _NP32_Encode_Dither_##enc##_##fmt(NP32_Instance_t *handle, uint8_t *dst, uint16_t first,            \
+                                                  uint16_t count)                                                   \
+    {                                                                                                               \
+        _NP32_LOCALS_##enc                                                                                          \
+        const NP32_RGB16_t *src = handle->_Dither_Buffer;                                                           \
+        uint8_t *err = handle->_Dither_Err + (3U * first);                                                          \
+        uint32_t scale[3];                                                                                          \
+        NP32_RGB_t curr_col;                                                                                        \
+        uint16_t i;                                                                                                 \
+                                                                                                                    \
+        _NP32_Dither_Scales(handle, scale);                                                                         \
+        for (i = first; i < first + count; i++, err += 3)                                                           \
+        {                                                                                                           \
+            curr_col.R = _NP32_Dither_Quant(src[i].R, scale[0], &err[0]);                                           \
+            curr_col.G = _NP32_Dither_Quant(src[i].G, scale[1], &err[1]);                                           \
+            curr_col.B = _NP32_Dither_Quant(src[i].B, scale[2], &err[2]);                                           \
+            _NP32_FMT_##fmt(curr_col, _NP32_PUT_##enc);                                                             \
+        }                                                                                                           \
+    }
+
+// Defines the encoder _NP32_Encode_Wide_<enc>_<fmt> of a 16-bit pixel format, which replaces the temporal dithering:
+// The values of the high-precision colour buffer (not rotated) get sent with their full precision, scaled by the
+// brightness and the white balance.
+#define _NP32_DEFINE_WIDE_ENCODER(enc,fmt)                                                                          \
+    static void _NP32_Encode_Wide_##enc##_##fmt(NP32_Instance_t *handle, uint8_t *dst, uint16_t first,              \
+                                                uint16_t count)                                                     \
+    {                                                                                                               \
+        _NP32_LOCALS_##enc                                                                                          \
+        const NP32_RGB16_t *src = handle->_Dither_Buffer;                                                           \
+        uint32_t scale[3];                                                                                          \
+        NP32_RGB16_t curr_col;                                                                                      \
+        uint16_t i;                                                                                                 \
+                                                                                                                    \
+        _NP32_Dither_Scales(handle, scale);                                                                         \
+        for (i = first; i < first + count; i++)                                                                     \
+        {                                                                                                           \
+            curr_col.R = (uint16_t) ((src[i].R * scale[0]) >> 8);                                                   \
+            curr_col.G = (uint16_t) ((src[i].G * scale[1]) >> 8);                                                   \
+            curr_col.B = (uint16_t) ((src[i].B * scale[2]) >> 8);                                                   \
+            _NP32_FMT_WIDE_##fmt(curr_col, _NP32_PUT_##enc);                                                        \
+        }                                                                                                           \
+    }
+
+// Defines the encoders of all encodings (with the given definition macro) for a pixel format.
+#define _NP32_DEFINE_ENCODERS(def,fmt)  def(PWM, fmt) def(PWM_Timing, fmt) def(SPI3, fmt) def(SPI4, fmt)
+
+// Defines all encoders of a pixel format, with and without temporal dithering.
+#define _NP32_DEFINE_FORMAT(fmt)    _NP32_DEFINE_ENCODERS(_NP32_DEFINE_ENCODER, fmt)                               \
+                                    _NP32_DEFINE_ENCODERS(_NP32_DEFINE_DITHER_ENCODER, fmt)
+
+// Row of the encoder tables of a pixel format: PWM, PWM with a timing profile, SPI3 and SPI4. The prefix is empty or
+// Dither_.
+#define _NP32_ENCODER_ROW(pre,fmt)  { _NP32_Encode_##pre##PWM_##fmt, _NP32_Encode_##pre##PWM_Timing_##fmt,         \
+                                      _NP32_Encode_##pre##SPI3_##fmt, _NP32_Encode_##pre##SPI4_##fmt }
+
+const uint8_t NP32_Gamma_2_2[256] =
+{
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,
+      1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+      3,   3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+      6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  11,  11,  11,  12,
+     12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,
+     20,  20,  21,  22,  22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,  29,
+     30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,  39,  39,  40,  41,
+     42,  43,  43,  44,  45,  46,  47,  48,  49,  49,  50,  51,  52,  53,  54,  55,
+     56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+     73,  74,  75,  76,  77,  78,  79,  81,  82,  83,  84,  85,  87,  88,  89,  90,
+     91,  93,  94,  95,  97,  98,  99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+    113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+    137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+    163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+    192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+    223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255
+};
+
+static int8_t _NP32_Build_Col_LUT(NP32_Instance_t *handle);
+static int8_t _NP32_Check_Config(NP32_Instance_t *handle);
+static uint32_t _NP32_Recalc_DMA_Buf(NP32_Instance_t *handle);
+static void _NP32_Start_Frame(NP32_Instance_t *handle);
+static void _NP32_Frame_Done(NP32_Instance_t *handle);
+static int8_t _NP32_Setup_Encoding(NP32_Instance_t *handle);
+static void _NP32_Timing_Row(const NP32_Timing_t *timing, uint8_t n, uint32_t *row);
+static uint32_t _NP32_DMA_Buf_Bytes(NP32_Instance_t *handle);
+static void _NP32_Encode_LEDs(NP32_Instance_t *handle, uint8_t *dst, uint16_t first, uint16_t count);
+static _NP32_Encoder_t _NP32_Get_Encoder(NP32_Instance_t *handle, uint8_t dither);
+static void _NP32_Stream_Fill_Half(NP32_Instance_t *handle, uint8_t half);
+static void _NP32_Stream_Half_Done(NP32_Instance_t *handle, uint8_t half);
+static void _NP32_Power_Count(const NP32_RGB_t *buf, uint16_t count, uint32_t *sum, uint8_t add);
+static void _NP32_Power_Recount(NP32_Instance_t *handle);
+static uint64_t _NP32_Power_Dynamic_uA(NP32_Instance_t *handle);
+static void _NP32_Power_Limit(NP32_Instance_t *handle);
+
+#if defined(NP32_CFG_STATS)
+#if !defined(NP32_CFG_STATS_TIME)
+#if defined(NP32_CFG_HOST)
+// Monotonic clock in nanoseconds (truncated, only differences are used).
+static inline uint32_t _NP32_Host_Time(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t) (((uint64_t) ts.tv_sec * 1000000000ULL) + (uint64_t) ts.tv_nsec);
+}
+#define NP32_CFG_STATS_TIME()       _NP32_Host_Time()
+#else
+// DWT cycle counter of the Cortex-M3 / M4. Gets enabled by setting TRCENA (DEMCR) and CYCCNTENA (DWT_CTRL).
+#define _NP32_DEMCR                 (*(volatile uint32_t *) 0xE000EDFCUL)
+#define _NP32_DWT_CTRL              (*(volatile uint32_t *) 0xE0001000UL)
+#define _NP32_DWT_CYCCNT            (*(volatile uint32_t *) 0xE0001004UL)
+#define _NP32_STATS_TIME_INIT()     do { _NP32_DEMCR |= 0x01000000UL; _NP32_DWT_CTRL |= 0x01UL; } while (0)
+#define NP32_CFG_STATS_TIME()       _NP32_DWT_CYCCNT
+#endif
+#endif
+#if !defined(_NP32_STATS_TIME_INIT)
+#define _NP32_STATS_TIME_INIT()     do { } while (0)
+#endif
+#endif
+
+// Statistics hooks of the hot path. Without NP32_CFG_STATS, they are empty and get optimised out.
+static inline uint32_t _NP32_Stats_Now(void)
+{
+#if defined(NP32_CFG_STATS)
+    return (uint32_t) NP32_CFG_STATS_TIME();
+#else
+    return 0;
+#endif
+}
+
+static inline void _NP32_Stats_Encode(NP32_Instance_t *handle, uint32_t start)
+{
+#if defined(NP32_CFG_STATS)
+    uint32_t t = _NP32_Stats_Now() - start;
+
+    handle->_Stats.Encode_Time_Last = t;
+    handle->_Stats.Encode_Time_Total += t;
+    if (t > handle->_Stats.Encode_Time_Max)
+        handle->_Stats.Encode_Time_Max = t;
+#endif
+}
+
+static inline void _NP32_Stats_Wait(NP32_Instance_t *handle, uint32_t start)
+{
+#if defined(NP32_CFG_STATS)
+    uint32_t t = _NP32_Stats_Now() - start;
+
+    handle->_Stats.Wait_Time_Total += t;
+    if (t > handle->_Stats.Wait_Time_Max)
+        handle->_Stats.Wait_Time_Max = t;
+#endif
+}
+
+static inline void _NP32_Stats_Skipped(NP32_Instance_t *handle)
+{
+#if defined(NP32_CFG_STATS)
+    handle->_Stats.Frames_Skipped++;
+#endif
+}
+
+static inline void _NP32_Stats_Frame_Start(NP32_Instance_t *handle)
+{
+#if defined(NP32_CFG_STATS)
+    uint32_t now = _NP32_Stats_Now();
+
+    // The interval is only known from the second frame on.
+    if (handle->_Stats.Frames_Sent > 0)
+        handle->_Stats.Frame_Interval_Last = now - handle->_Stats_Frame_Start;
+    handle->_Stats_Frame_Start = now;
+#endif
+}
+
+static inline void _NP32_Stats_Frame_Done(NP32_Instance_t *handle)
+{
+#if defined(NP32_CFG_STATS)
+    uint32_t t = _NP32_Stats_Now() - handle->_Stats_Frame_Start;
+
+    handle->_Stats.Frames_Sent++;
+    handle->_Stats.DMA_Time_Last = t;
+    if (t > handle->_Stats.DMA_Time_Max)
+        handle->_Stats.DMA_Time_Max = t;
+#endif
+}
+
+// Reverses the colours of the LEDs from index lo to index hi.
+static inline void _NP32_Reverse(NP32_RGB_t *buf, uint16_t lo, uint16_t hi)
+{
+    NP32_RGB_t t;
+
+    while (lo < hi)
+    {
+        t = buf[lo];
+        buf[lo++] = buf[hi];
+        buf[hi--] = t;
+    }
+}
+
+// Divides the given product of two bytes by 255 (rounded), without a division.
+static inline uint8_t _NP32_Div255(uint32_t x)
+{
+    x += 128;
+    return (uint8_t) ((x + (x >> 8)) >> 8);
+}
+
+// Gets the brightness applied while encoding: The global brightness, scaled down by the power limiter. Rounded down, so
+// the limited frame stays within the budget.
+static inline uint8_t _NP32_Eff_Brightness(const NP32_Instance_t *handle)
+{
+    if (handle->_Power_Scale == 255U)
+        return handle->_Brightness;
+
+    return (uint8_t) (((uint32_t) handle->_Brightness * handle->_Power_Scale) / 255U);
+}
+
+// Gets the scale factors (0 to 256) of the channels R, G and B applied by the temporal dithering: The brightness and
+// the white balance. In the LED disable mode, all scale factors are 0.
+static inline void _NP32_Dither_Scales(const NP32_Instance_t *handle, uint32_t *scale)
+{
+    uint32_t b = _NP32_Eff_Brightness(handle);
+
+    if (handle->LED_Disable_Flag == 1U)
+    {
+        scale[0] = scale[1] = scale[2] = 0;
+        return;
+    }
+
+    scale[0] = ((b * handle->_White_Balance.R * 256U) + 32512U) / 65025U;
+    scale[1] = ((b * handle->_White_Balance.G * 256U) + 32512U) / 65025U;
+    scale[2] = ((b * handle->_White_Balance.B * 256U) + 32512U) / 65025U;
+}
+
+// Quantises a scaled high-precision value to 8 bits. The remainder (fraction) gets accumulated in err and carried over
+// to the next frame.
+static inline uint8_t _NP32_Dither_Quant(uint16_t val, uint32_t scale, uint8_t *err)
+{
+    uint32_t acc = ((val * scale) >> 8) + *err;
+
+    *err = (uint8_t) acc;
+    return (acc > 0xFFFFU) ? 0xFFU : (uint8_t) (acc >> 8);
+}
+
+// Converts a full-scale HSV colour with a hue lower than NP32_HSV8_HUE_STEPS. The upper byte of the hue selects the
+// sector of the colour wheel, the lower byte the position within the sector.
+static inline void _NP32_HSV8_Convert(uint16_t h, uint8_t s, uint8_t v, NP32_RGB_t *rgb)
+{
+    uint8_t f = h & 0xFF;
+    uint8_t p, q, t;
+
+    p = _NP32_Div255(v * (255U - s));
+    q = _NP32_Div255(v * (255U - _NP32_Div255(s * f)));
+    t = _NP32_Div255(v * (255U - _NP32_Div255(s * (255U - f))));
+
+    switch (h >> 8)
+    {
+    case 0:  rgb->R = v; rgb->G = t; rgb->B = p; break;
+    case 1:  rgb->R = q; rgb->G = v; rgb->B = p; break;
+    case 2:  rgb->R = p; rgb->G = v; rgb->B = t; break;
+    case 3:  rgb->R = p; rgb->G = q; rgb->B = v; break;
+    case 4:  rgb->R = t; rgb->G = p; rgb->B = v; break;
+    default: rgb->R = v; rgb->G = p; rgb->B = q; break;
+    }
+}
 
 int8_t NP32_Init(NP32_Instance_t *handle)
 {
-    // Check for LED count.
-    if (handle->LED_Count == 0)
+    if (_NP32_Check_Config(handle) != 0)
         return -1;
     
     // Allocate memory for the LED color buffer.
@@ -17,22 +416,79 @@ int8_t NP32_Init(NP32_Instance_t *handle)
     if (handle->LED_Col_Buffer == NULL)
         return -1;
     // Allocate memory for the DMA buffer.
-    handle->_DMA_Buffer = (uint16_t *) calloc((handle->LED_Count * 24) + NP32_WS2812_ZERO_PERIODS, sizeof(uint16_t));
+    handle->_DMA_Buffer = (NP32_DMA_t *) calloc((_NP32_DMA_Buf_Bytes(handle) + sizeof(NP32_DMA_t) - 1) /
+                                                sizeof(NP32_DMA_t), sizeof(NP32_DMA_t));
     if (handle->_DMA_Buffer == NULL)
+    {
+        free(handle->LED_Col_Buffer);
+        handle->LED_Col_Buffer = NULL;
         return -1;
+    }
 
-    // Check if DMA call is null.
-    if (handle->StartDMA_Call == NULL)
+    handle->_Static_Flags = 0U;
+    handle->_Col_LUT_Buffer = NULL;
+    handle->_Alloc_Col_Buffer = handle->LED_Col_Buffer;
+    _NP32_Reset_State(handle);
+
+    return 0;
+}
+
+int8_t NP32_InitStatic(NP32_Instance_t *handle, NP32_RGB_t *col_buf, NP32_DMA_t *dma_buf, uint32_t dma_buf_entries,
+                       uint8_t *col_lut)
+{
+    uint32_t bytes;
+
+    if (col_buf == NULL || dma_buf == NULL || _NP32_Check_Config(handle) != 0)
+        return -1;
+
+    // The encoder writes words into the DMA buffer.
+    bytes = _NP32_DMA_Buf_Bytes(handle);
+    if (((uintptr_t) dma_buf & 0x03U) != 0 || ((uint64_t) dma_buf_entries * sizeof(NP32_DMA_t)) < bytes)
         return -1;
 
+    memset(col_buf, 0x00, (size_t) handle->LED_Count * sizeof(NP32_RGB_t));
+    memset(dma_buf, 0x00, (size_t) dma_buf_entries * sizeof(NP32_DMA_t));
+    handle->LED_Col_Buffer = col_buf;
+    handle->_DMA_Buffer = dma_buf;
+    handle->_Col_LUT_Buffer = col_lut;
+    handle->_Alloc_Col_Buffer = NULL;
+
+    handle->_Static_Flags = _NP32_STATIC_BUFFERS;
+    if (col_lut != NULL)
+        handle->_Static_Flags |= _NP32_STATIC_COL_LUT;
+    _NP32_Reset_State(handle);
+
     return 0;
 }
 
+uint32_t NP32_GetDMABufEntries(NP32_Instance_t *handle)
+{
+    if (_NP32_Check_Config(handle) != 0)
+        return 0;
+
+    return (_NP32_DMA_Buf_Bytes(handle) + sizeof(NP32_DMA_t) - 1) / sizeof(NP32_DMA_t);
+}
+
 void NP32_DeInit(NP32_Instance_t *handle)
 {
-    // Free the LED color buffer and the DMA buffer.
-    free(handle->LED_Col_Buffer);
-    free(handle->_DMA_Buffer);
+    // Free the LED color buffers, the DMA buffer and the colour correction table, unless owned by the caller.
+    free(handle->_Alloc_Col_Buffer);
+    free(handle->_Alloc_Back_Buffer);
+    free(handle->_Alloc_Dither_Buffer);
+    if (!(handle->_Static_Flags & _NP32_STATIC_BUFFERS))
+        free(handle->_DMA_Buffer);
+    if (!(handle->_Static_Flags & _NP32_STATIC_COL_LUT))
+        free(handle->_Col_LUT_Buffer);
+    handle->LED_Col_Buffer = NULL;
+    handle->_Back_Buffer = NULL;
+    handle->_Alloc_Col_Buffer = NULL;
+    handle->_Alloc_Back_Buffer = NULL;
+    handle->_Dither_Buffer = NULL;
+    handle->_Dither_Err = NULL;
+    handle->_Alloc_Dither_Buffer = NULL;
+    handle->_DMA_Buffer = NULL;
+    handle->_Col_LUT_Buffer = NULL;
+    handle->_Col_LUT = NULL;
 
     // Set the count of LEDs to 0.
     handle->LED_Count = 0;
@@ -40,27 +496,77 @@ void NP32_DeInit(NP32_Instance_t *handle)
 
 int8_t NP32_Update(NP32_Instance_t *handle)
 {
+    uint32_t t;
+
     // Check for initialised handle.
     if (handle->LED_Col_Buffer == NULL || handle->_DMA_Buffer == NULL)
         return -1;
     
     // Wait for the last update to complete.
+    t = _NP32_Stats_Now();
     while (handle->DMA_Busy_Flag);
+    _NP32_Stats_Wait(handle, t);
 
-    // Recalculate the DMA-buffer.
-    _NP32_Recalc_DMA_Buf(handle);
+    _NP32_Start_Frame(handle);
 
-    // Start the DMA stream to the PWM peripheral.
-    handle->DMA_Busy_Flag = 1U;
-    handle->StartDMA_Call(handle->_DMA_Buffer, (handle->LED_Count * 24) + NP32_WS2812_ZERO_PERIODS);
+    return 0;
+}
+
+int8_t NP32_UpdateAsync(NP32_Instance_t *handle)
+{
+    uint8_t queued;
+
+    // Check for initialised handle.
+    if (handle->LED_Col_Buffer == NULL || handle->_DMA_Buffer == NULL)
+        return -1;
+
+    // Queue the frame first: If the DMA stream completes in between, the callback already starts the frame.
+    queued = handle->_Frame_Queued;
+    handle->_Frame_Queued = 1U;
+    if (handle->DMA_Busy_Flag)
+    {
+        // A frame, which is still queued, gets replaced by this one.
+        if (queued)
+            _NP32_Stats_Skipped(handle);
+        return 1;
+    }
+
+    // The DMA is idle (so no callback can interfere), start the frame right away.
+    handle->_Frame_Queued = 0U;
+    _NP32_Start_Frame(handle);
+
+    return 0;
+}
+
+int8_t NP32_MarkDirty(NP32_Instance_t *handle, uint16_t lower_bound, uint16_t higher_bound)
+{
+    if (lower_bound >= handle->LED_Count || higher_bound >= handle->LED_Count || lower_bound > higher_bound)
+        return -1;
+
+    _NP32_Mark_Dirty(handle, lower_bound, higher_bound);
+
+    // The colour buffer got written directly, the old colours of the span are gone.
+    _NP32_Power_Recount(handle);
 
     return 0;
 }
 
 void NP32_DMAComplete_Callback(NP32_Instance_t *handle)
 {
+    if (handle->Stream_Chunk_LEDs != 0)
+    {
+        _NP32_Stream_Half_Done(handle, 1);
+        return;
+    }
+
     if (handle->DMA_Busy_Flag)
-        handle->DMA_Busy_Flag = 0;
+        _NP32_Frame_Done(handle);
+}
+
+void NP32_DMAHalfComplete_Callback(NP32_Instance_t *handle)
+{
+    if (handle->Stream_Chunk_LEDs != 0)
+        _NP32_Stream_Half_Done(handle, 0);
 }
 
 void NP32_HSV_To_RGB(NP32_HSV_t hsv, NP32_RGB_t *rgb)
@@ -128,14 +634,67 @@ void NP32_HSV_To_RGB(NP32_HSV_t hsv, NP32_RGB_t *rgb)
     rgb->B = (rgb->B * hsv.V) / 100;
 }
 
+void NP32_HSV8_To_RGB(NP32_HSV_t hsv, NP32_RGB_t *rgb)
+{
+    if (hsv.H >= NP32_HSV8_HUE_STEPS)
+        hsv.H %= NP32_HSV8_HUE_STEPS;
+
+    _NP32_HSV8_Convert(hsv.H, hsv.S, hsv.V, rgb);
+}
+
+void NP32_HSV8_To_RGB_Array(const NP32_HSV_t *hsv, NP32_RGB_t *rgb, uint16_t count)
+{
+    uint16_t i, h;
+
+    for (i = 0; i < count; i++)
+    {
+        h = hsv[i].H;
+        if (h >= NP32_HSV8_HUE_STEPS)
+            h %= NP32_HSV8_HUE_STEPS;
+        _NP32_HSV8_Convert(h, hsv[i].S, hsv[i].V, &rgb[i]);
+    }
+}
+
+int8_t NP32_Timing_Compute(NP32_Timing_t *timing, uint32_t tim_clk_hz, uint32_t bit_ns, uint32_t t0h_ns,
+                           uint32_t t1h_ns, uint32_t reset_ns)
+{
+    uint32_t period, t0h, t1h;
+    uint8_t n;
+
+    if (bit_ns == 0 || t0h_ns == 0 || t0h_ns >= t1h_ns || t1h_ns >= bit_ns)
+        return -1;
+
+    period = NP32_NS_TO_COUNTS(tim_clk_hz, bit_ns);
+    t0h = NP32_NS_TO_COUNTS(tim_clk_hz, t0h_ns);
+    t1h = NP32_NS_TO_COUNTS(tim_clk_hz, t1h_ns);
+
+    // The bits have to stay distinguishable after rounding and all compare values have to fit into the DMA buffer.
+    if (t0h < 2 || t1h <= t0h || period <= t1h || (period - 1) > NP32_DMA_MAX)
+        return -1;
+
+    timing->Period = (uint16_t) (period - 1);
+    timing->T0H = (uint16_t) (t0h - 1);
+    timing->T1H = (uint16_t) (t1h - 1);
+    timing->Reset_Periods = (uint16_t) ((reset_ns + bit_ns - 1) / bit_ns);
+    for (n = 0; n < 16; n++)
+        _NP32_Timing_Row(timing, n, timing->_LUT[n]);
+
+    return 0;
+}
+
 /*--------------------------------------------------------------------------------------------------------------------*/
 
 int8_t NP32_SetLED_RGB(NP32_Instance_t *handle, uint16_t led_index, NP32_RGB_t rgb)
 {
+    NP32_RGB_t *col;
+
     if (led_index >= handle->LED_Count)
         return -1;
     
-    handle->LED_Col_Buffer[led_index] = rgb;
+    col = &handle->LED_Col_Buffer[_NP32_Phys(handle, led_index)];
+    _NP32_Power_Swap(handle, *col, rgb);
+    *col = rgb;
+    _NP32_Mark_Dirty(handle, led_index, led_index);
 
     return 0;
 }
@@ -155,6 +714,10 @@ int8_t NP32_SetAllLEDs_RGB(NP32_Instance_t *handle, NP32_RGB_t rgb)
     {
         handle->LED_Col_Buffer[i] = rgb;
     }
+    handle->_Power_Sum[0] = (uint32_t) handle->LED_Count * rgb.R;
+    handle->_Power_Sum[1] = (uint32_t) handle->LED_Count * rgb.G;
+    handle->_Power_Sum[2] = (uint32_t) handle->LED_Count * rgb.B;
+    _NP32_Mark_All_Dirty(handle);
 
     return 0;
 }
@@ -168,15 +731,11 @@ int8_t NP32_SetAllLEDs_HSV(NP32_Instance_t *handle, NP32_HSV_t hsv)
 
 int8_t NP32_SetLEDSpan_RGB(NP32_Instance_t *handle, uint16_t lower_bound, uint16_t higher_bound, NP32_RGB_t rgb)
 {
-    uint16_t i;
-
     if (lower_bound >= handle->LED_Count || higher_bound >= handle->LED_Count || lower_bound > higher_bound)
         return -1;
     
-    for (i = lower_bound; i <= higher_bound; i++)
-    {
-        handle->LED_Col_Buffer[i] = rgb;
-    }
+    _NP32_Fill(handle, lower_bound, higher_bound, rgb);
+    _NP32_Mark_Dirty(handle, lower_bound, higher_bound);
 
     return 0;
 }
@@ -188,6 +747,86 @@ int8_t NP32_SetLEDSpan_HSV(NP32_Instance_t *handle, uint16_t lower_bound, uint16
     return NP32_SetLEDSpan_RGB(handle, lower_bound, higher_bound, rgb);
 }
 
+int8_t NP32_SetLEDSpan_Rainbow(NP32_Instance_t *handle, uint16_t lower_bound, uint16_t higher_bound, uint16_t hue_start,
+                               uint16_t hue_range, uint8_t s, uint8_t v)
+{
+    const uint32_t wheel = (uint32_t) NP32_HSV8_HUE_STEPS << 16;
+    uint32_t hue, step;
+    uint16_t i;
+
+    if (lower_bound >= handle->LED_Count || higher_bound >= handle->LED_Count || lower_bound > higher_bound)
+        return -1;
+
+    // Advance the hue in 16.16 fixed-point, so the span covers the hue range evenly.
+    hue = ((uint32_t) hue_start % NP32_HSV8_HUE_STEPS) << 16;
+    step = (((uint32_t) hue_range << 16) / (higher_bound - lower_bound + 1U)) % wheel;
+
+    _NP32_Power_Span(handle, lower_bound, higher_bound, 0);
+    for (i = lower_bound; i <= higher_bound; i++)
+    {
+        _NP32_HSV8_Convert(hue >> 16, s, v, &handle->LED_Col_Buffer[_NP32_Phys(handle, i)]);
+        hue += step;
+        if (hue >= wheel)
+            hue -= wheel;
+    }
+    _NP32_Power_Span(handle, lower_bound, higher_bound, 1);
+    _NP32_Mark_Dirty(handle, lower_bound, higher_bound);
+
+    return 0;
+}
+
+int8_t NP32_SetLEDSpan_Gradient(NP32_Instance_t *handle, uint16_t lower_bound, uint16_t higher_bound, NP32_HSV_t from,
+                                NP32_HSV_t to)
+{
+    const int32_t wheel = (int32_t) NP32_HSV8_HUE_STEPS << 16;
+    int32_t hue, sat, val, dh, ds, dv, n;
+    uint16_t i, h;
+
+    if (lower_bound >= handle->LED_Count || higher_bound >= handle->LED_Count || lower_bound > higher_bound)
+        return -1;
+
+    from.H %= NP32_HSV8_HUE_STEPS;
+    to.H %= NP32_HSV8_HUE_STEPS;
+
+    // Take the shorter way around the colour wheel.
+    dh = (int32_t) to.H - from.H;
+    if (dh > (int32_t) (NP32_HSV8_HUE_STEPS / 2))
+        dh -= NP32_HSV8_HUE_STEPS;
+    else if (dh < -(int32_t) (NP32_HSV8_HUE_STEPS / 2))
+        dh += NP32_HSV8_HUE_STEPS;
+
+    // Interpolate all components in 16.16 fixed-point. Rounding at each LED makes the last LED hit the end colour.
+    n = higher_bound - lower_bound;
+    dh = (n != 0) ? (dh * 65536) / n : 0;
+    ds = (n != 0) ? (((int32_t) to.S - from.S) * 65536) / n : 0;
+    dv = (n != 0) ? (((int32_t) to.V - from.V) * 65536) / n : 0;
+    hue = ((int32_t) from.H << 16) + 0x8000;
+    sat = ((int32_t) from.S << 16) + 0x8000;
+    val = ((int32_t) from.V << 16) + 0x8000;
+
+    _NP32_Power_Span(handle, lower_bound, higher_bound, 0);
+    for (i = lower_bound; i <= higher_bound; i++)
+    {
+        h = (uint16_t) (hue >> 16);
+        if (h >= NP32_HSV8_HUE_STEPS)
+            h -= NP32_HSV8_HUE_STEPS;
+        _NP32_HSV8_Convert(h, (uint8_t) (sat >> 16), (uint8_t) (val >> 16),
+                           &handle->LED_Col_Buffer[_NP32_Phys(handle, i)]);
+
+        hue += dh;
+        if (hue < 0)
+            hue += wheel;
+        else if (hue >= wheel)
+            hue -= wheel;
+        sat += ds;
+        val += dv;
+    }
+    _NP32_Power_Span(handle, lower_bound, higher_bound, 1);
+    _NP32_Mark_Dirty(handle, lower_bound, higher_bound);
+
+    return 0;
+}
+
 int8_t NP32_ClearAllLEDs(NP32_Instance_t *handle)
 {
     return NP32_SetAllLEDs_RGB(handle, NP32_COL_BLACK);
@@ -195,141 +834,948 @@ int8_t NP32_ClearAllLEDs(NP32_Instance_t *handle)
 
 int8_t NP32_ShiftLeft(NP32_Instance_t *handle, uint16_t shift_amount)
 {
-    uint16_t i, s;
+    if (handle->LED_Count == 0)
+        return -1;
+    if (shift_amount >= handle->LED_Count)
+        return NP32_ClearAllLEDs(handle);
 
-    for (i = 0; i < handle->LED_Count; i++)
-    {
-        s = shift_amount + i;
-        if (s >= handle->LED_Count)
-            handle->LED_Col_Buffer[i] = NP32_COL_BLACK;
-        else
-            handle->LED_Col_Buffer[i] = handle->LED_Col_Buffer[s];    
-    }
+    // Rotate the ring and clear the LEDs, which got shifted in at the end.
+    NP32_RotateLeft(handle, shift_amount);
+    _NP32_Fill(handle, handle->LED_Count - shift_amount, handle->LED_Count - 1, NP32_COL_BLACK);
 
     return 0;
 }
 
 int8_t NP32_ShiftRight(NP32_Instance_t *handle, uint16_t shift_amount)
 {
-    uint16_t i;
+    if (handle->LED_Count == 0)
+        return -1;
+    if (shift_amount >= handle->LED_Count)
+        return NP32_ClearAllLEDs(handle);
 
-    for (i = handle->LED_Count - 1; i >= 0; i--)
-    {
-        if (shift_amount > i)
-            handle->LED_Col_Buffer[i] = NP32_COL_BLACK;
-        else
-            handle->LED_Col_Buffer[i] = handle->LED_Col_Buffer[i - shift_amount];    
-    }
+    // Rotate the ring and clear the LEDs, which got shifted in at the start.
+    NP32_RotateRight(handle, shift_amount);
+    if (shift_amount > 0)
+        _NP32_Fill(handle, 0, shift_amount - 1, NP32_COL_BLACK);
 
     return 0;
 }
 
 int8_t NP32_RotateLeft(NP32_Instance_t *handle, uint16_t rotate_amount)
 {
-    NP32_RGB_t *buf;
-    uint16_t i, s;
+    uint32_t offset;
 
-    buf = (NP32_RGB_t *) calloc(rotate_amount, sizeof(NP32_RGB_t));
-    if (buf == NULL)
+    if (handle->LED_Count == 0)
         return -1;
 
-    for (i = 0; i < handle->LED_Count; i++)
-    {
-        s = rotate_amount + i;
-
-        if (i < rotate_amount)
-            buf[i] = handle->LED_Col_Buffer[i];
+    rotate_amount %= handle->LED_Count;
+    if (rotate_amount == 0)
+        return 0;
 
-        if (s >= handle->LED_Count)
-            handle->LED_Col_Buffer[i] = buf[s - handle->LED_Count];
-        else
-            handle->LED_Col_Buffer[i] = handle->LED_Col_Buffer[s];    
-    }
+    // Only move the start of the ring, the colours get rearranged by the encoder.
+    offset = (uint32_t) handle->_Ring_Offset + rotate_amount;
+    if (offset >= handle->LED_Count)
+        offset -= handle->LED_Count;
+    handle->_Ring_Offset = (uint16_t) offset;
 
-    free(buf);
+    _NP32_Mark_All_Dirty(handle);
 
     return 0;
 }
 
 int8_t NP32_RotateRight(NP32_Instance_t *handle, uint16_t rotate_amount)
 {
-    NP32_RGB_t *buf;
-    uint16_t i;
+    if (handle->LED_Count == 0)
+        return -1;
 
-    buf = (NP32_RGB_t *) calloc(rotate_amount, sizeof(NP32_RGB_t));
-    if (buf == NULL)
+    rotate_amount %= handle->LED_Count;
+    return NP32_RotateLeft(handle, (handle->LED_Count - rotate_amount) % handle->LED_Count);
+}
+
+int8_t NP32_GetLED_RGB(NP32_Instance_t *handle, uint16_t led_index, NP32_RGB_t *rgb)
+{
+    if (led_index >= handle->LED_Count)
         return -1;
 
-    for (i = handle->LED_Count - 1; i >= 0; i--)
-    {
-        if (i >= handle->LED_Count - rotate_amount)
-            buf[i - (handle->LED_Count - rotate_amount)] = handle->LED_Col_Buffer[i];
+    *rgb = handle->LED_Col_Buffer[_NP32_Phys(handle, led_index)];
 
-        if (rotate_amount > i)
-            handle->LED_Col_Buffer[i] = buf[i];
-        else
-            handle->LED_Col_Buffer[i] = handle->LED_Col_Buffer[i - rotate_amount];    
+    return 0;
+}
+
+int8_t NP32_Normalize(NP32_Instance_t *handle)
+{
+    uint16_t n = handle->LED_Count, k = handle->_Ring_Offset;
+
+    if (n == 0)
+        return -1;
+    if (k == 0)
+        return 0;
+
+    // Rotate the colour buffer in place by three reversals, so LED i is stored at index i again. The encoded colours
+    // do not change.
+    _NP32_Reverse(handle->LED_Col_Buffer, 0, k - 1);
+    _NP32_Reverse(handle->LED_Col_Buffer, k, n - 1);
+    _NP32_Reverse(handle->LED_Col_Buffer, 0, n - 1);
+    handle->_Ring_Offset = 0;
+
+    return 0;
+}
+
+int8_t NP32_SetLEDs_RGB(NP32_Instance_t *handle, uint16_t first, const NP32_RGB_t *rgb, uint16_t count)
+{
+    NP32_RGB_t *buf = handle->LED_Col_Buffer;
+    uint16_t p, n;
+
+    if (count == 0 || first >= handle->LED_Count || count > handle->LED_Count - first)
+        return -1;
+
+    // Copy up to the end of the ring, then the rest to its start.
+    _NP32_Power_Span(handle, first, first + count - 1, 0);
+    p = _NP32_Phys(handle, first);
+    n = handle->LED_Count - p;
+    if (n > count)
+        n = count;
+    memcpy(&buf[p], rgb, (size_t) n * sizeof(NP32_RGB_t));
+    memcpy(&buf[0], &rgb[n], (size_t) (count - n) * sizeof(NP32_RGB_t));
+    _NP32_Power_Span(handle, first, first + count - 1, 1);
+
+    _NP32_Mark_Dirty(handle, first, first + count - 1);
+
+    return 0;
+}
+
+int8_t NP32_SetLEDs_GRB(NP32_Instance_t *handle, uint16_t first, const uint8_t *grb, uint16_t count)
+{
+    NP32_RGB_t *buf = handle->LED_Col_Buffer;
+    uint16_t i, p;
+
+    if (count == 0 || first >= handle->LED_Count || count > handle->LED_Count - first)
+        return -1;
+
+    _NP32_Power_Span(handle, first, first + count - 1, 0);
+    p = _NP32_Phys(handle, first);
+    for (i = 0; i < count; i++)
+    {
+        buf[p].G = grb[0];
+        buf[p].R = grb[1];
+        buf[p].B = grb[2];
+        grb += 3;
+        if (++p == handle->LED_Count)
+            p = 0;
     }
+    _NP32_Power_Span(handle, first, first + count - 1, 1);
 
-    free(buf);
+    _NP32_Mark_Dirty(handle, first, first + count - 1);
 
     return 0;
 }
 
-/*--------------------------------------------------------------------------------------------------------------------*/
+int8_t NP32_AttachFrame(NP32_Instance_t *handle, NP32_RGB_t *frame)
+{
+    if (frame == NULL || handle->LED_Count == 0)
+        return -1;
+
+    handle->LED_Col_Buffer = frame;
+    handle->_Ring_Offset = 0;
+    _NP32_Power_Recount(handle);
+    _NP32_Mark_All_Dirty(handle);
+
+    return 0;
+}
 
-static void _NP32_Recalc_DMA_Buf(NP32_Instance_t *handle)
+int8_t NP32_EnableDoubleBuffer(NP32_Instance_t *handle, NP32_RGB_t *back_buf)
 {
-    NP32_RGB_t curr_col;
-    uint16_t i, i_dma = 0;
-    uint8_t b;
+    if (handle->LED_Count == 0)
+        return -1;
 
-    if (handle->LED_Disable_Flag == 1U)
+    if (back_buf == NULL)
     {
-        for (i_dma = 0; i_dma < (handle->LED_Count * 24) + NP32_WS2812_ZERO_PERIODS; i_dma++)
+        // Keep an already allocated back buffer.
+        if (handle->_Alloc_Back_Buffer == NULL)
         {
-            handle->_DMA_Buffer[i_dma] = 0x00;
+            handle->_Alloc_Back_Buffer = (NP32_RGB_t *) calloc(handle->LED_Count, sizeof(NP32_RGB_t));
+            if (handle->_Alloc_Back_Buffer == NULL)
+                return -1;
         }
+        back_buf = handle->_Alloc_Back_Buffer;
     }
-    else
-    {
-        // Fill the DMA buffer with color values.
+
+    handle->_Back_Buffer = back_buf;
+
+    return 0;
+}
+
+NP32_RGB_t *NP32_GetBackBuffer(NP32_Instance_t *handle)
+{
+    return handle->_Back_Buffer;
+}
+
+int8_t NP32_Commit(NP32_Instance_t *handle)
+{
+    return _NP32_Commit_Span(handle, 0, handle->LED_Count - 1);
+}
+
+int8_t NP32_SetBrightness(NP32_Instance_t *handle, uint8_t brightness)
+{
+    handle->_Brightness = brightness;
+    return _NP32_Build_Col_LUT(handle);
+}
+
+int8_t NP32_SetGamma(NP32_Instance_t *handle, const uint8_t *gamma_table)
+{
+    handle->_Gamma_Table = gamma_table;
+    return _NP32_Build_Col_LUT(handle);
+}
+
+int8_t NP32_SetWhiteBalance(NP32_Instance_t *handle, NP32_RGB_t white_balance)
+{
+    handle->_White_Balance = white_balance;
+    return _NP32_Build_Col_LUT(handle);
+}
+
+int8_t NP32_EnableDither(NP32_Instance_t *handle, NP32_RGB16_t *buf, uint8_t *err_buf)
+{
+    NP32_RGB_t col;
+    uint16_t i;
+
+    if (handle->LED_Col_Buffer == NULL || (buf != NULL && err_buf == NULL))
+        return -1;
+
+    if (buf == NULL)
+    {
+        // Allocate both buffers at once, the errors follow the colours. Keep an already allocated block.
+        if (handle->_Alloc_Dither_Buffer == NULL)
+        {
+            handle->_Alloc_Dither_Buffer = (NP32_RGB16_t *) malloc((size_t) handle->LED_Count *
+                                                                   (sizeof(NP32_RGB16_t) + 3U));
+            if (handle->_Alloc_Dither_Buffer == NULL)
+                return -1;
+        }
+        buf = handle->_Alloc_Dither_Buffer;
+        err_buf = (uint8_t *) (buf + handle->LED_Count);
+
+        // Start from the current colours.
         for (i = 0; i < handle->LED_Count; i++)
         {
-            // Get the current LED color.
-            curr_col = handle->LED_Col_Buffer[i];
-
-            // Fill the DMA buffer.
-            i_dma = i * 24;
-            // Bits G7 to G0.
-            b = 8;
-            do
-            {
-                handle->_DMA_Buffer[i_dma++] = NP32_RESOLVE_BIT_TIME(curr_col.G, --b);
-            }
-            while (b > 0);
-            // Bits R7 to R0.
-            b = 8;
-            do
-            {
-                handle->_DMA_Buffer[i_dma++] = NP32_RESOLVE_BIT_TIME(curr_col.R, --b);
-            }
-            while (b > 0);
-            // Bits B7 to B0.
-            b = 8;
-            do
-            {
-                handle->_DMA_Buffer[i_dma++] = NP32_RESOLVE_BIT_TIME(curr_col.B, --b);
-            }
-            while (b > 0);
+            col = handle->LED_Col_Buffer[_NP32_Phys(handle, i)];
+            buf[i] = (NP32_RGB16_t){ col.R * 257U, col.G * 257U, col.B * 257U };
         }
+    }
+
+    memset(err_buf, 0x00, NP32_DITHER_ERR_SIZE(handle->LED_Count));
+    handle->_Dither_Buffer = buf;
+    handle->_Dither_Err = err_buf;
+    handle->_Encoder = _NP32_Get_Encoder(handle, 1);
+    _NP32_Mark_All_Dirty(handle);
+
+    return 0;
+}
+
+void NP32_DisableDither(NP32_Instance_t *handle)
+{
+    handle->_Dither_Buffer = NULL;
+    handle->_Dither_Err = NULL;
+    handle->_Encoder = _NP32_Get_Encoder(handle, 0);
+    _NP32_Mark_All_Dirty(handle);
+}
+
+NP32_RGB16_t *NP32_GetDitherBuffer(NP32_Instance_t *handle)
+{
+    return handle->_Dither_Buffer;
+}
+
+int8_t NP32_SetLED_RGB16(NP32_Instance_t *handle, uint16_t led_index, NP32_RGB16_t rgb)
+{
+    if (handle->_Dither_Buffer == NULL || led_index >= handle->LED_Count)
+        return -1;
+
+    // All LEDs get re-encoded at every update, no need to mark the LED dirty.
+    handle->_Dither_Buffer[led_index] = rgb;
+
+    return 0;
+}
+
+int8_t NP32_SetPowerLimit(NP32_Instance_t *handle, uint32_t budget_mA, uint16_t channel_uA, uint16_t idle_uA)
+{
+    if (handle->LED_Col_Buffer == NULL)
+        return -1;
+
+    // Allocate the colour correction table now, the limiter rebuilds it from the update (maybe in an interrupt).
+    if (budget_mA != 0 && handle->_Col_LUT_Buffer == NULL)
+    {
+        handle->_Col_LUT_Buffer = (uint8_t *) malloc(NP32_COL_LUT_SIZE);
+        if (handle->_Col_LUT_Buffer == NULL)
+            return -1;
+    }
+
+    // The channel sums get counted now and kept up to date by the setters from then on.
+    handle->_Power_Budget_mA = budget_mA;
+    handle->_Power_Channel_uA = channel_uA;
+    handle->_Power_Idle_uA = idle_uA;
+    _NP32_Power_Recount(handle);
+    if (budget_mA == 0 && handle->_Power_Scale != 255U)
+    {
+        handle->_Power_Scale = 255U;
+        return _NP32_Build_Col_LUT(handle);
+    }
+
+    return 0;
+}
+
+uint32_t NP32_GetPowerEstimate(NP32_Instance_t *handle)
+{
+    uint64_t ua;
+
+    if (handle->LED_Col_Buffer == NULL)
+        return 0;
+
+    ua = _NP32_Power_Dynamic_uA(handle) + ((uint64_t) handle->_Power_Idle_uA * handle->LED_Count);
+
+    return (uint32_t) ((ua + 999U) / 1000U);
+}
+
+uint8_t NP32_GetPowerScale(NP32_Instance_t *handle)
+{
+    return handle->_Power_Scale;
+}
+
+int8_t NP32_GetStats(NP32_Instance_t *handle, NP32_Stats_t *stats)
+{
+#if defined(NP32_CFG_STATS)
+    *stats = handle->_Stats;
+    return 0;
+#else
+    (void) handle;
+    (void) stats;
+    return -1;
+#endif
+}
+
+void NP32_ResetStats(NP32_Instance_t *handle)
+{
+#if defined(NP32_CFG_STATS)
+    memset(&handle->_Stats, 0x00, sizeof(NP32_Stats_t));
+#else
+    (void) handle;
+#endif
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static int8_t _NP32_Check_Config(NP32_Instance_t *handle)
+{
+    // Check for LED count.
+    if (handle->LED_Count == 0)
+        return -1;
+
+    // Check if DMA call is null. In streaming mode, a DMA stop call is also needed.
+    if (handle->StartDMA_Call == NULL)
+        return -1;
+    if (handle->Stream_Chunk_LEDs != 0 && handle->StopDMA_Call == NULL)
+        return -1;
+
+    // Set up the DMA buffer geometry of the selected encoding and pixel format.
+    if (_NP32_Setup_Encoding(handle) != 0)
+        return -1;
+
+    // The length of a DMA transfer is limited to 65535 units.
+    if ((_NP32_DMA_Buf_Bytes(handle) / handle->_Unit_Bytes) > 0xFFFFUL)
+        return -1;
+
+    return 0;
+}
+
+int8_t _NP32_Commit_Span(NP32_Instance_t *handle, uint16_t lower_bound, uint16_t higher_bound)
+{
+    NP32_RGB_t *front = handle->LED_Col_Buffer;
+    uint32_t sum[3];
+    uint16_t n;
+
+    if (handle->_Back_Buffer == NULL)
+        return -1;
+
+    // Swap the buffers. The back buffer is drawn without the ring offset, so a rotated front buffer moves all LEDs.
+    if (handle->_Ring_Offset != 0)
+    {
+        lower_bound = 0;
+        higher_bound = handle->LED_Count - 1;
+    }
+    if (handle->_Power_Budget_mA != 0)
+    {
+        // A partial commit only counts the span, in which the back buffer differs from the front buffer.
+        memcpy(sum, handle->_Power_Sum, sizeof(sum));
+        if (lower_bound == 0 && higher_bound == handle->LED_Count - 1)
+        {
+            sum[0] = sum[1] = sum[2] = 0;
+            _NP32_Power_Count(handle->_Back_Buffer, handle->LED_Count, sum, 1);
+        }
+        else if (lower_bound <= higher_bound)
+        {
+            n = higher_bound - lower_bound + 1;
+            _NP32_Power_Count(front + lower_bound, n, sum, 0);
+            _NP32_Power_Count(handle->_Back_Buffer + lower_bound, n, sum, 1);
+        }
+        memcpy(handle->_Power_Back_Sum, handle->_Power_Sum, sizeof(sum));
+        memcpy(handle->_Power_Sum, sum, sizeof(sum));
+    }
+    handle->LED_Col_Buffer = handle->_Back_Buffer;
+    handle->_Back_Buffer = front;
+    handle->_Ring_Offset = 0;
+    if (lower_bound <= higher_bound)
+        _NP32_Mark_Dirty(handle, lower_bound, higher_bound);
+
+    return 0;
+}
+
+void _NP32_Reset_State(NP32_Instance_t *handle)
+{
+    handle->DMA_Busy_Flag = 0U;
+    handle->_Frame_Queued = 0U;
+    handle->Stream_Underrun_Count = 0;
+
+    // No colour correction until set.
+    handle->_Brightness = 255U;
+    handle->_Gamma_Table = NULL;
+    handle->_White_Balance = (NP32_RGB_t){ 255U, 255U, 255U };
+    handle->_Col_LUT = NULL;
+    handle->_Ring_Offset = 0;
+    handle->_Back_Buffer = NULL;
+    handle->_Alloc_Back_Buffer = NULL;
+    handle->_Dither_Buffer = NULL;
+    handle->_Dither_Err = NULL;
+    handle->_Alloc_Dither_Buffer = NULL;
+    handle->_Encoder = _NP32_Get_Encoder(handle, 0);
+    handle->_FrameDone_Hook = NULL;
+    handle->_FrameDone_Ctx = NULL;
+
+    // No power limit until set.
+    handle->_Power_Sum[0] = handle->_Power_Sum[1] = handle->_Power_Sum[2] = 0;
+    handle->_Power_Back_Sum[0] = handle->_Power_Back_Sum[1] = handle->_Power_Back_Sum[2] = 0;
+    handle->_Power_Budget_mA = 0;
+    handle->_Power_Channel_uA = NP32_WS2812_CHANNEL_UA;
+    handle->_Power_Idle_uA = NP32_WS2812_IDLE_UA;
+    handle->_Power_Scale = 255U;
+
+    // Force a full encode at the first update.
+    _NP32_Mark_All_Dirty(handle);
+    handle->_Encoded_Disable_Flag = 0xFFU;
+    handle->_Stale_Low = 0xFFFFU;
+    handle->_Stale_High = 0;
+
+#if defined(NP32_CFG_STATS)
+    _NP32_STATS_TIME_INIT();
+    NP32_ResetStats(handle);
+#endif
+
+    return;
+}
+
+static void _NP32_Start_Frame(NP32_Instance_t *handle)
+{
+    uint32_t bytes = _NP32_DMA_Buf_Bytes(handle);
+
+    // Cap the frame to the power budget before encoding it.
+    if (handle->_Power_Budget_mA != 0)
+        _NP32_Power_Limit(handle);
+
+    if (handle->Stream_Chunk_LEDs != 0)
+    {
+        // Streaming mode: Pre-fill both halves of the ring, the rest gets encoded from the half callbacks.
+        handle->_Stream_LED_Pos = 0;
+        handle->_Stream_Reset_Left = handle->_Reset_Bytes;
+        handle->_Stream_Live_Halves = 0;
+        handle->_Stream_Next_Half = 0;
+        _NP32_Stream_Fill_Half(handle, 0);
+        _NP32_Stream_Fill_Half(handle, 1);
+    }
+    else
+    {
+        // Recalculate the DMA-buffer.
+        bytes = _NP32_Recalc_DMA_Buf(handle);
+    }
+
+    // Start the DMA stream to the PWM / SPI peripheral.
+    _NP32_Stats_Frame_Start(handle);
+    handle->DMA_Busy_Flag = 1U;
+    handle->StartDMA_Call(handle->_DMA_Buffer, bytes / handle->_Unit_Bytes);
+
+    return;
+}
+
+static void _NP32_Frame_Done(NP32_Instance_t *handle)
+{
+    _NP32_Stats_Frame_Done(handle);
+    handle->DMA_Busy_Flag = 0;
+
+    // Start the queued frame (if any) before notifying the application, so the LEDs are kept busy.
+    if (handle->_Frame_Queued)
+    {
+        handle->_Frame_Queued = 0U;
+        _NP32_Start_Frame(handle);
+    }
+
+    if (handle->_FrameDone_Hook != NULL)
+        handle->_FrameDone_Hook(handle);
+    if (handle->FrameComplete_Call != NULL)
+        handle->FrameComplete_Call(handle);
+
+    return;
+}
+
+static int8_t _NP32_Setup_Encoding(NP32_Instance_t *handle)
+{
+    const NP32_Timing_t *t = handle->Timing;
+    uint32_t reset_periods = NP32_WS2812_ZERO_PERIODS;
+    uint32_t bits = NP32_FORMAT_BYTES(handle->Format) * 8U;
+    uint32_t row[(4 * sizeof(NP32_DMA_t)) / 4];
+    uint8_t n;
+
+    // Check for an encoder of the pixel format.
+    if (_NP32_Get_Encoder(handle, 0) == NULL)
+        return -1;
+
+    if (t != NULL)
+    {
+        // Check the timing profile.
+        if (t->T0H == 0 || t->T0H >= t->T1H || t->T1H >= t->Period)
+            return -1;
+#if defined(NP32_CFG_DMA_BYTE_BUFFER)
+        // The compare values have to fit into the DMA buffer entries (always true for 16-bit entries).
+        if (t->Period > NP32_DMA_MAX)
+            return -1;
+#endif
+        reset_periods = t->Reset_Periods;
+
+        // The bit encoding table of the profile has to match its compare values (e.g. not filled in by hand).
+        for (n = 0; n < 16; n++)
+        {
+            _NP32_Timing_Row(t, n, row);
+            if (memcmp(row, t->_LUT[n], sizeof(row)) != 0)
+                return -1;
+        }
+    }
+
+    switch (handle->Encoding)
+    {
+        case NP32_ENCODING_PWM:
+            // One compare value per bit.
+            handle->_Unit_Bytes = sizeof(NP32_DMA_t);
+            handle->_LED_Bytes = bits * sizeof(NP32_DMA_t);
+            handle->_Reset_Bytes = reset_periods * sizeof(NP32_DMA_t);
+            break;
+        case NP32_ENCODING_SPI3:
+            // One 3-bit symbol per bit, the reset gets sent as zero symbols.
+            handle->_Unit_Bytes = 1;
+            handle->_LED_Bytes = (bits * 3) / 8;
+            handle->_Reset_Bytes = ((reset_periods * 3) + 7) / 8;
+            break;
+        case NP32_ENCODING_SPI4:
+            // One 4-bit symbol per bit, the reset gets sent as zero symbols.
+            handle->_Unit_Bytes = 1;
+            handle->_LED_Bytes = (bits * 4) / 8;
+            handle->_Reset_Bytes = ((reset_periods * 4) + 7) / 8;
+            break;
+        default:
+            return -1;
+    }
+
+    return 0;
+}
+
+static void _NP32_Timing_Row(const NP32_Timing_t *timing, uint8_t n, uint32_t *row)
+{
+    uint32_t v;
+    uint8_t b;
+
+    // The compare values of bit 3 down to bit 0 of the nibble, packed into words in DMA buffer order.
+    memset(row, 0, 4 * sizeof(NP32_DMA_t));
+    for (b = 0; b < 4; b++)
+    {
+        v = ((n >> (3 - b)) & 0x01) ? timing->T1H : timing->T0H;
+        row[(b * sizeof(NP32_DMA_t)) / 4] |= v << ((b * sizeof(NP32_DMA_t) * 8) % 32);
+    }
+
+    return;
+}
+
+static uint32_t _NP32_DMA_Buf_Bytes(NP32_Instance_t *handle)
+{
+    if (handle->Stream_Chunk_LEDs != 0)
+        return 2UL * handle->Stream_Chunk_LEDs * handle->_LED_Bytes;
+
+    return ((uint32_t) handle->LED_Count * handle->_LED_Bytes) + handle->_Reset_Bytes;
+}
+
+static void _NP32_Encode_LEDs(NP32_Instance_t *handle, uint8_t *dst, uint16_t first, uint16_t count)
+{
+    uint16_t p = _NP32_Phys(handle, first);
+    uint16_t n = handle->LED_Count - p;
+
+    // The high-precision colour buffer of the temporal dithering is not rotated.
+    if (handle->_Dither_Buffer != NULL)
+    {
+        handle->_Encoder(handle, dst, first, count);
+        return;
+    }
+
+    // The LEDs are contiguous in the colour buffer up to its end, the rest continues at its start.
+    if (n >= count)
+    {
+        handle->_Encoder(handle, dst, p, count);
+    }
+    else
+    {
+        handle->_Encoder(handle, dst, p, n);
+        handle->_Encoder(handle, dst + ((uint32_t) n * handle->_LED_Bytes), 0, count - n);
+    }
+
+    return;
+}
+
+_NP32_DEFINE_FORMAT(GRB)
+#if !defined(NP32_CFG_GRB_ONLY)
+_NP32_DEFINE_FORMAT(RGB)
+_NP32_DEFINE_FORMAT(BRG)
+_NP32_DEFINE_FORMAT(GRBW)
+_NP32_DEFINE_ENCODERS(_NP32_DEFINE_ENCODER, GRB16)
+_NP32_DEFINE_ENCODERS(_NP32_DEFINE_WIDE_ENCODER, GRB16)
+#endif
+
+/**
+ * \brief The encoders of all pixel formats (rows, in the order of the NP32_FORMAT_ constants) and encodings (columns).
+ */
+static const _NP32_Encoder_t _NP32_Encoders[][4] =
+{
+    _NP32_ENCODER_ROW(, GRB),
+#if !defined(NP32_CFG_GRB_ONLY)
+    _NP32_ENCODER_ROW(, RGB),
+    _NP32_ENCODER_ROW(, BRG),
+    _NP32_ENCODER_ROW(, GRBW),
+    _NP32_ENCODER_ROW(, GRB16),
+#endif
+};
+
+/**
+ * \brief The encoders of the temporal dithering, laid out like _NP32_Encoders. The 16-bit pixel format sends the
+ *        high-precision colours directly instead.
+ */
+static const _NP32_Encoder_t _NP32_Dither_Encoders[][4] =
+{
+    _NP32_ENCODER_ROW(Dither_, GRB),
+#if !defined(NP32_CFG_GRB_ONLY)
+    _NP32_ENCODER_ROW(Dither_, RGB),
+    _NP32_ENCODER_ROW(Dither_, BRG),
+    _NP32_ENCODER_ROW(Dither_, GRBW),
+    _NP32_ENCODER_ROW(Wide_, GRB16),
+#endif
+};
+
+static _NP32_Encoder_t _NP32_Get_Encoder(NP32_Instance_t *handle, uint8_t dither)
+{
+    uint8_t col;
+
+    if (handle->Format >= sizeof(_NP32_Encoders) / sizeof(_NP32_Encoders[0]))
+        return NULL;
+
+    switch (handle->Encoding)
+    {
+        case NP32_ENCODING_SPI3:
+            col = 2;
+            break;
+        case NP32_ENCODING_SPI4:
+            col = 3;
+            break;
+        default:
+            col = (handle->Timing != NULL) ? 1 : 0;
+            break;
+    }
+    return dither ? _NP32_Dither_Encoders[handle->Format][col] : _NP32_Encoders[handle->Format][col];
+}
+
+static void _NP32_Stream_Fill_Half(NP32_Instance_t *handle, uint8_t half)
+{
+    uint8_t *dst;
+    uint16_t n;
+    uint32_t left = (uint32_t) handle->Stream_Chunk_LEDs * handle->_LED_Bytes;
+    uint32_t t = _NP32_Stats_Now();
+
+    dst = (uint8_t *) handle->_DMA_Buffer + (half * left);
+
+    // Nothing left of the frame: Keep the data line low until the stream gets stopped.
+    if (handle->_Stream_LED_Pos >= handle->LED_Count && handle->_Stream_Reset_Left == 0)
+    {
+        memset(dst, 0x00, left);
+        return;
+    }
+
+    // Encode the next chunk of LEDs.
+    n = handle->LED_Count - handle->_Stream_LED_Pos;
+    if (n > handle->Stream_Chunk_LEDs)
+        n = handle->Stream_Chunk_LEDs;
+    if (n > 0)
+    {
+        _NP32_Encode_LEDs(handle, dst, handle->_Stream_LED_Pos, n);
+        handle->_Stream_LED_Pos += n;
+        dst += (uint32_t) n * handle->_LED_Bytes;
+        left -= (uint32_t) n * handle->_LED_Bytes;
+    }
+
+    // Fill the rest of the half with the reset periods.
+    memset(dst, 0x00, left);
+    if (left >= handle->_Stream_Reset_Left)
+        handle->_Stream_Reset_Left = 0;
+    else
+        handle->_Stream_Reset_Left -= left;
+
+    handle->_Stream_Live_Halves++;
+    _NP32_Stats_Encode(handle, t);
+
+    return;
+}
+
+static void _NP32_Stream_Half_Done(NP32_Instance_t *handle, uint8_t half)
+{
+    if (!handle->DMA_Busy_Flag)
+        return;
+
+    // A notification out of order means that the encoder could not keep up with the DMA stream.
+    if (half != handle->_Stream_Next_Half)
+        handle->Stream_Underrun_Count++;
+    handle->_Stream_Next_Half = half ^ 1U;
+
+    if (handle->_Stream_Live_Halves > 0)
+        handle->_Stream_Live_Halves--;
+
+    // Stop the stream as soon as the last data and reset periods were transmitted.
+    if (handle->_Stream_Live_Halves == 0)
+    {
+        handle->StopDMA_Call();
+        _NP32_Frame_Done(handle);
+        return;
+    }
+
+    // Encode the next chunk into the half, which has just been transmitted.
+    _NP32_Stream_Fill_Half(handle, half);
+
+    return;
+}
+
+static uint32_t _NP32_Recalc_DMA_Buf(NP32_Instance_t *handle)
+{
+    uint8_t *buf = (uint8_t *) handle->_DMA_Buffer;
+    uint32_t t = _NP32_Stats_Now(), end;
+    uint16_t count = handle->LED_Count;
+
+    // Toggling the LED disable mode changes the colour of all LEDs.
+    if (handle->LED_Disable_Flag != handle->_Encoded_Disable_Flag)
+    {
+        handle->_Encoded_Disable_Flag = handle->LED_Disable_Flag;
+        _NP32_Mark_All_Dirty(handle);
 
         // Append 0 values for the reset time.
-        for (i = 0; i < NP32_WS2812_ZERO_PERIODS; i++)
+        memset(buf + ((uint32_t) handle->LED_Count * handle->_LED_Bytes), 0x00, handle->_Reset_Bytes);
+    }
+
+    // The temporal dithering changes the sent colours at every frame.
+    if (handle->_Dither_Buffer != NULL)
+        _NP32_Mark_All_Dirty(handle);
+
+    // Prefix update mode: Only the LEDs up to the highest changed one get transmitted.
+    if (handle->Prefix_Update_Flag == 1U)
+        count = (handle->_Dirty_Low <= handle->_Dirty_High) ? handle->_Dirty_High + 1 : 0;
+
+    // The stale LEDs within the transmitted LEDs have to be re-encoded.
+    if (handle->_Stale_Low <= handle->_Stale_High && handle->_Stale_Low < count)
+    {
+        _NP32_Mark_Dirty(handle, handle->_Stale_Low, (handle->_Stale_High < count) ? handle->_Stale_High : count - 1);
+        if (handle->_Stale_High < count)
+        {
+            handle->_Stale_Low = 0xFFFFU;
+            handle->_Stale_High = 0;
+        }
+        else
+        {
+            handle->_Stale_Low = count;
+        }
+    }
+
+    // Re-encode the LEDs, which changed since the last update.
+    if (handle->_Dirty_Low <= handle->_Dirty_High)
+    {
+        _NP32_Encode_LEDs(handle, buf + ((uint32_t) handle->_Dirty_Low * handle->_LED_Bytes), handle->_Dirty_Low,
+                          handle->_Dirty_High - handle->_Dirty_Low + 1);
+    }
+
+    // Clear the dirty span.
+    handle->_Dirty_Low = 0xFFFFU;
+    handle->_Dirty_High = 0;
+
+    // Move the reset periods behind the prefix. They overwrite the data of the following LEDs, which become stale.
+    if (count < handle->LED_Count)
+    {
+        memset(buf + ((uint32_t) count * handle->_LED_Bytes), 0x00, handle->_Reset_Bytes);
+        end = count + ((handle->_Reset_Bytes + handle->_LED_Bytes - 1) / handle->_LED_Bytes) - 1;
+        if (end >= handle->LED_Count)
+            end = handle->LED_Count - 1;
+        if (count < handle->_Stale_Low)
+            handle->_Stale_Low = count;
+        if (end > handle->_Stale_High)
+            handle->_Stale_High = (uint16_t) end;
+    }
+
+    _NP32_Stats_Encode(handle, t);
+
+    return ((uint32_t) count * handle->_LED_Bytes) + handle->_Reset_Bytes;
+}
+
+static int8_t _NP32_Build_Col_LUT(NP32_Instance_t *handle)
+{
+    const uint8_t scale[3] = { handle->_White_Balance.R, handle->_White_Balance.G, handle->_White_Balance.B };
+    const uint8_t brightness = _NP32_Eff_Brightness(handle);
+    uint8_t *lut;
+    uint16_t x;
+    uint8_t c, y;
+
+    // Without any correction, the encoder takes the colours from the colour buffer as they are.
+    if (brightness == 255U && handle->_Gamma_Table == NULL && scale[0] == 255U && scale[1] == 255U &&
+        scale[2] == 255U)
+    {
+        handle->_Col_LUT = NULL;
+        _NP32_Mark_All_Dirty(handle);
+        return 0;
+    }
+
+    // The memory of the table is kept until de-init, so fading back and forth does not allocate again.
+    if (handle->_Col_LUT_Buffer == NULL)
+    {
+        handle->_Col_LUT_Buffer = (uint8_t *) malloc(NP32_COL_LUT_SIZE);
+        if (handle->_Col_LUT_Buffer == NULL)
+            return -1;
+    }
+    lut = handle->_Col_LUT_Buffer;
+
+    // Gamma first, then scale the linear output by the brightness and the white balance of the channel.
+    for (c = 0; c < 3; c++)
+    {
+        for (x = 0; x < 256; x++)
         {
-            handle->_DMA_Buffer[i_dma++] = 0x00;
+            y = (handle->_Gamma_Table != NULL) ? handle->_Gamma_Table[x] : (uint8_t) x;
+            lut[(c * 256) + x] = _NP32_Div255(_NP32_Div255(y * scale[c]) * brightness);
         }
     }
+    handle->_Col_LUT = lut;
+
+    // All LEDs have to be encoded with the new table.
+    _NP32_Mark_All_Dirty(handle);
+
+    return 0;
+}
+
+static void _NP32_Power_Count(const NP32_RGB_t *buf, uint16_t count, uint32_t *sum, uint8_t add)
+{
+    uint32_t r = 0, g = 0, b = 0;
+    uint16_t i;
+
+    for (i = 0; i < count; i++)
+    {
+        r += buf[i].R;
+        g += buf[i].G;
+        b += buf[i].B;
+    }
+
+    if (add)
+    {
+        sum[0] += r;
+        sum[1] += g;
+        sum[2] += b;
+    }
+    else
+    {
+        sum[0] -= r;
+        sum[1] -= g;
+        sum[2] -= b;
+    }
+
+    return;
+}
+
+static void _NP32_Power_Recount(NP32_Instance_t *handle)
+{
+    if (handle->_Power_Budget_mA == 0)
+        return;
+
+    handle->_Power_Sum[0] = handle->_Power_Sum[1] = handle->_Power_Sum[2] = 0;
+    _NP32_Power_Count(handle->LED_Col_Buffer, handle->LED_Count, handle->_Power_Sum, 1);
 
     return;
-}
\ No newline at end of file
+}
+
+static uint64_t _NP32_Power_Dynamic_uA(NP32_Instance_t *handle)
+{
+    const NP32_RGB16_t *hp = handle->_Dither_Buffer;
+    const NP32_RGB_t *buf = handle->LED_Col_Buffer;
+    uint32_t sum[3] = { handle->_Power_Sum[0], handle->_Power_Sum[1], handle->_Power_Sum[2] };
+    uint64_t weighted;
+    uint16_t i;
+
+    if (handle->LED_Disable_Flag == 1U)
+        return 0;
+
+    // The running sums only cover the colour buffer while the limiter is enabled. Otherwise count the sent buffer.
+    if (hp != NULL || handle->_Power_Budget_mA == 0)
+    {
+        sum[0] = sum[1] = sum[2] = 0;
+        for (i = 0; i < handle->LED_Count; i++)
+        {
+            if (hp != NULL)
+            {
+                sum[0] += hp[i].R >> 8;
+                sum[1] += hp[i].G >> 8;
+                sum[2] += hp[i].B >> 8;
+            }
+            else
+            {
+                sum[0] += buf[i].R;
+                sum[1] += buf[i].G;
+                sum[2] += buf[i].B;
+            }
+        }
+    }
+
+    // Each channel draws its full current at 255 after the white balance and the brightness (gamma not included).
+    weighted = ((uint64_t) sum[0] * handle->_White_Balance.R) + ((uint64_t) sum[1] * handle->_White_Balance.G) +
+               ((uint64_t) sum[2] * handle->_White_Balance.B);
+
+    return (weighted * handle->_Brightness * handle->_Power_Channel_uA) / (255ULL * 255ULL * 255ULL);
+}
+
+static void _NP32_Power_Limit(NP32_Instance_t *handle)
+{
+    uint64_t budget = (uint64_t) handle->_Power_Budget_mA * 1000U;
+    uint64_t idle = (uint64_t) handle->_Power_Idle_uA * handle->LED_Count;
+    uint64_t dyn = _NP32_Power_Dynamic_uA(handle);
+    uint64_t margin;
+    uint8_t old = handle->_Power_Scale, scale;
+
+    // The colour correction table rounds each channel to the nearest value, which is up to 1 step above the estimate.
+    // A limited frame reserves that margin, so it stays within the budget.
+    margin = ((uint64_t) handle->LED_Count * 3U * handle->_Power_Channel_uA) / 255U;
+
+    // Scale the brightness, so the channels draw at most the part of the budget left by the quiescent current.
+    if (dyn + idle <= budget)
+        scale = 255U;
+    else if (budget <= idle + margin)
+        scale = 0;
+    else
+        scale = (uint8_t) (((budget - idle - margin) * 255U) / dyn);
+
+    // Lower the scale right away, but only raise it by a noticeable step, as a change re-encodes all LEDs.
+    if (scale == old || (scale > old && scale != 255U && scale - old < 4U))
+        return;
+
+    handle->_Power_Scale = scale;
+    if (_NP32_Build_Col_LUT(handle) != 0)
+        handle->_Power_Scale = old;
+
+    return;
+}
@@ -0,0 +1,201 @@
+// neopixel32_anim.c
+// Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+
+#include "neopixel32_anim.h"
+#include "neopixel32_priv.h"
+#include <stddef.h>
+#include <string.h>
+
+static uint8_t _NP32_Anim_Frame_Pending(NP32_Instance_t *handle);
+static void _NP32_Anim_Render(NP32_Anim_t *anim);
+static void _NP32_Anim_Effect_Span(NP32_Anim_t *anim, NP32_Effect_t *e, uint16_t *first, uint16_t *count);
+
+int8_t NP32_Anim_Init(NP32_Anim_t *anim)
+{
+    if (anim->Instance == NULL || anim->Tick_Period_us == 0 || anim->GetTime_Call == NULL)
+        return -1;
+
+    // The effects render into the back buffer, while the front buffer gets encoded.
+    if (NP32_GetBackBuffer(anim->Instance) == NULL && NP32_EnableDoubleBuffer(anim->Instance, NULL) != 0)
+        return -1;
+
+    anim->Tick = 0;
+    anim->Frames_Rendered = 0;
+    anim->Ticks_Coalesced = 0;
+    anim->_Effect_Count = 0;
+    anim->_Next_Tick = 0;
+    anim->_Next_Time = anim->GetTime_Call();
+
+    // Both buffers may hold anything, so the first frame clears all LEDs.
+    anim->_Span_Low = 0;
+    anim->_Span_High = anim->Instance->LED_Count - 1;
+
+    return 0;
+}
+
+int8_t NP32_Anim_AddEffect(NP32_Anim_t *anim, NP32_Effect_t *effect)
+{
+    if (effect == NULL || effect->Render_Call == NULL || anim->_Effect_Count >= NP32_ANIM_MAX_EFFECTS)
+        return -1;
+
+    anim->_Effects[anim->_Effect_Count++] = effect;
+
+    return 0;
+}
+
+int8_t NP32_Anim_RemoveEffect(NP32_Anim_t *anim, NP32_Effect_t *effect)
+{
+    uint8_t k;
+
+    for (k = 0; k < anim->_Effect_Count; k++)
+    {
+        if (anim->_Effects[k] == effect)
+        {
+            // Keep the render order of the remaining effects.
+            memmove(&anim->_Effects[k], &anim->_Effects[k + 1],
+                    (anim->_Effect_Count - k - 1) * sizeof(NP32_Effect_t *));
+            anim->_Effect_Count--;
+            return 0;
+        }
+    }
+
+    return -1;
+}
+
+int8_t NP32_Anim_Run(NP32_Anim_t *anim)
+{
+    uint32_t now, late;
+
+    if (anim->Instance->LED_Col_Buffer == NULL || NP32_GetBackBuffer(anim->Instance) == NULL)
+        return -1;
+
+    // Wait for the next timestep.
+    now = anim->GetTime_Call();
+    if ((int32_t) (now - anim->_Next_Time) < 0)
+        return 0;
+
+    // Wait for the vertical sync: The previous frame has to be started by the DMA-complete interrupt first.
+    if (_NP32_Anim_Frame_Pending(anim->Instance))
+        return 0;
+
+    // Coalesce all timesteps, which passed in the meantime, into this frame.
+    late = (now - anim->_Next_Time) / anim->Tick_Period_us;
+    anim->Tick = anim->_Next_Tick + late;
+    anim->Ticks_Coalesced += late;
+    anim->_Next_Tick = anim->Tick + 1;
+    anim->_Next_Time += (late + 1) * anim->Tick_Period_us;
+
+    _NP32_Anim_Render(anim);
+    NP32_UpdateAsync(anim->Instance);
+    anim->Frames_Rendered++;
+
+    return 1;
+}
+
+uint32_t NP32_Anim_TimeToNext(NP32_Anim_t *anim)
+{
+    int32_t d = (int32_t) (anim->_Next_Time - anim->GetTime_Call());
+
+    return (d > 0) ? (uint32_t) d : 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static uint8_t _NP32_Anim_Frame_Pending(NP32_Instance_t *handle)
+{
+    // A queued frame gets encoded from the front buffer by the DMA-complete interrupt. In streaming mode, the front
+    // buffer gets read during the whole transmission.
+    if (handle->_Frame_Queued)
+        return 1U;
+    if (handle->Stream_Chunk_LEDs != 0 && handle->DMA_Busy_Flag)
+        return 1U;
+
+    return 0U;
+}
+
+static void _NP32_Anim_Effect_Span(NP32_Anim_t *anim, NP32_Effect_t *e, uint16_t *first, uint16_t *count)
+{
+    uint16_t led_count = anim->Instance->LED_Count;
+
+    *first = e->First_LED;
+    *count = 0;
+    if (e->Enabled != 1U || e->First_LED >= led_count)
+        return;
+
+    *count = led_count - e->First_LED;
+    if (e->LED_Count != 0 && e->LED_Count < *count)
+        *count = e->LED_Count;
+
+    return;
+}
+
+static void _NP32_Anim_Render(NP32_Anim_t *anim)
+{
+    NP32_Instance_t *handle = anim->Instance;
+    NP32_RGB_t *back = NP32_GetBackBuffer(handle);
+    const NP32_RGB_t *front = handle->LED_Col_Buffer;
+    NP32_Effect_t *e;
+    uint16_t first, count, lo = 0xFFFF, hi = 0, clr_lo, clr_hi;
+    uint8_t k;
+
+    // The union of the spans of the effects of this frame.
+    for (k = 0; k < anim->_Effect_Count; k++)
+    {
+        _NP32_Anim_Effect_Span(anim, anim->_Effects[k], &first, &count);
+        if (count == 0)
+            continue;
+        if (first < lo)
+            lo = first;
+        if (first + count - 1 > hi)
+            hi = first + count - 1;
+    }
+
+    // The spans of the previous frame have to turn black as well. A rotated front buffer does not match the back buffer
+    // at all, so all LEDs get cleared.
+    clr_lo = lo;
+    clr_hi = hi;
+    if (handle->_Ring_Offset != 0)
+    {
+        clr_lo = 0;
+        clr_hi = handle->LED_Count - 1;
+    }
+    else if (lo > hi)
+    {
+        clr_lo = anim->_Span_Low;
+        clr_hi = anim->_Span_High;
+    }
+    else if (anim->_Span_Low <= anim->_Span_High)
+    {
+        if (anim->_Span_Low < clr_lo)
+            clr_lo = anim->_Span_Low;
+        if (anim->_Span_High > clr_hi)
+            clr_hi = anim->_Span_High;
+    }
+
+    // The back buffer holds an older frame: The LEDs outside of the spans get taken from the front buffer, so only the
+    // spans change and have to be re-encoded.
+    if (clr_lo > clr_hi)
+    {
+        memcpy(back, front, (size_t) handle->LED_Count * sizeof(NP32_RGB_t));
+    }
+    else
+    {
+        memcpy(back, front, (size_t) clr_lo * sizeof(NP32_RGB_t));
+        memset(back + clr_lo, 0x00, (size_t) (clr_hi - clr_lo + 1) * sizeof(NP32_RGB_t));
+        memcpy(back + clr_hi + 1, front + clr_hi + 1, (size_t) (handle->LED_Count - clr_hi - 1) * sizeof(NP32_RGB_t));
+    }
+
+    for (k = 0; k < anim->_Effect_Count; k++)
+    {
+        e = anim->_Effects[k];
+        _NP32_Anim_Effect_Span(anim, e, &first, &count);
+        if (count != 0)
+            e->Render_Call(e, back + first, count, anim->Tick);
+    }
+
+    _NP32_Commit_Span(handle, clr_lo, clr_hi);
+    anim->_Span_Low = lo;
+    anim->_Span_High = hi;
+
+    return;
+}
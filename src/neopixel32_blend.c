@@ -0,0 +1,327 @@
+// neopixel32_blend.c
+// Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+
+#include "neopixel32_blend.h"
+#include "neopixel32_priv.h"
+#include <string.h>
+
+#if !defined(NP32_CFG_BLEND_NO_SIMD)
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#define _NP32_BLEND_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define _NP32_BLEND_NEON
+#elif defined(__ARM_FEATURE_SIMD32)
+// Only used for the saturating addition. Scaling and interpolation need multiplications, which stay SWAR.
+#include <arm_acle.h>
+#define _NP32_BLEND_SIMD32
+#endif
+#endif
+
+#define _NP32_BLEND_LANES       0x00FF00FFUL    // The low bytes of the 16-bit lanes of a word.
+
+// Operations of _NP32_Blend_Apply.
+#define _NP32_BLEND_OP_SCALE    0U
+#define _NP32_BLEND_OP_LERP     1U
+#define _NP32_BLEND_OP_ADD      2U
+
+static void _NP32_Scale_Bytes(uint8_t *dst, const uint8_t *src, uint32_t n, uint16_t w);
+static void _NP32_Lerp_Bytes(uint8_t *dst, const uint8_t *a, const uint8_t *b, uint32_t n, uint16_t w);
+static void _NP32_Add_Bytes(uint8_t *dst, const uint8_t *a, const uint8_t *b, uint32_t n);
+static int8_t _NP32_Blend_Apply(NP32_Instance_t *handle, uint16_t first, uint16_t count, uint8_t op,
+                                const NP32_RGB_t *a, const NP32_RGB_t *b, uint16_t w);
+
+// Maps a blend factor (0 to 255) to a multiplier (0 to 256), so 255 is the identity.
+static inline uint16_t _NP32_Blend_Weight(uint8_t f)
+{
+    return (uint16_t) f + (f >> 7);
+}
+
+static inline uint32_t _NP32_Load32(const uint8_t *p)
+{
+    uint32_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline void _NP32_Store32(uint8_t *p, uint32_t v)
+{
+    memcpy(p, &v, sizeof(v));
+}
+
+// Scales the 4 bytes of x by w (0 to 256): Two bytes per multiplication in 16-bit lanes, whose products (at most
+// 255 * 256) do not overflow into the next lane.
+static inline uint32_t _NP32_Scale4(uint32_t x, uint32_t w)
+{
+    return ((((x & _NP32_BLEND_LANES) * w) >> 8) & _NP32_BLEND_LANES) |
+           ((((x >> 8) & _NP32_BLEND_LANES) * w) & ~_NP32_BLEND_LANES);
+}
+
+// Interpolates the 4 bytes of a and b: (a * (256 - w) + b * w) / 256. The sum of a lane is at most 255 * 256 as well.
+static inline uint32_t _NP32_Lerp4(uint32_t a, uint32_t b, uint32_t w)
+{
+    uint32_t lo = ((a & _NP32_BLEND_LANES) * (256U - w)) + ((b & _NP32_BLEND_LANES) * w);
+    uint32_t hi = (((a >> 8) & _NP32_BLEND_LANES) * (256U - w)) + (((b >> 8) & _NP32_BLEND_LANES) * w);
+
+    return ((lo >> 8) & _NP32_BLEND_LANES) | (hi & ~_NP32_BLEND_LANES);
+}
+
+// Adds the 4 bytes of a and b, saturating at 255.
+static inline uint32_t _NP32_Add4(uint32_t a, uint32_t b)
+{
+#if defined(_NP32_BLEND_SIMD32)
+    return (uint32_t) __uqadd8(a, b);
+#else
+    // Add the low 7 bits, then the top bits without carry. A carry out of a byte sets the whole byte.
+    uint32_t r = ((a & 0x7F7F7F7FUL) + (b & 0x7F7F7F7FUL)) ^ ((a ^ b) & 0x80808080UL);
+    uint32_t c = ((a & b) | ((a | b) & ~r)) & 0x80808080UL;
+
+    return r | ((c >> 7) * 0xFFU);
+#endif
+}
+
+void NP32_BlendBuf_Scale(NP32_RGB_t *dst, const NP32_RGB_t *src, uint16_t count, uint8_t scale)
+{
+    _NP32_Scale_Bytes((uint8_t *) dst, (const uint8_t *) src, (uint32_t) count * sizeof(NP32_RGB_t),
+                      _NP32_Blend_Weight(scale));
+}
+
+void NP32_BlendBuf_Lerp(NP32_RGB_t *dst, const NP32_RGB_t *a, const NP32_RGB_t *b, uint16_t count, uint8_t alpha)
+{
+    _NP32_Lerp_Bytes((uint8_t *) dst, (const uint8_t *) a, (const uint8_t *) b, (uint32_t) count * sizeof(NP32_RGB_t),
+                     _NP32_Blend_Weight(alpha));
+}
+
+void NP32_BlendBuf_Add(NP32_RGB_t *dst, const NP32_RGB_t *a, const NP32_RGB_t *b, uint16_t count)
+{
+    _NP32_Add_Bytes((uint8_t *) dst, (const uint8_t *) a, (const uint8_t *) b, (uint32_t) count * sizeof(NP32_RGB_t));
+}
+
+int8_t NP32_Blend_Scale(NP32_Instance_t *handle, uint16_t first, uint16_t count, uint8_t scale)
+{
+    return _NP32_Blend_Apply(handle, first, count, _NP32_BLEND_OP_SCALE, NULL, NULL, _NP32_Blend_Weight(scale));
+}
+
+int8_t NP32_Blend_Lerp(NP32_Instance_t *handle, uint16_t first, const NP32_RGB_t *a, const NP32_RGB_t *b,
+                       uint16_t count, uint8_t alpha)
+{
+    if (a == NULL || b == NULL)
+        return -1;
+
+    return _NP32_Blend_Apply(handle, first, count, _NP32_BLEND_OP_LERP, a, b, _NP32_Blend_Weight(alpha));
+}
+
+int8_t NP32_Blend_Add(NP32_Instance_t *handle, uint16_t first, const NP32_RGB_t *src, uint16_t count)
+{
+    if (src == NULL)
+        return -1;
+
+    return _NP32_Blend_Apply(handle, first, count, _NP32_BLEND_OP_ADD, NULL, src, 0);
+}
+
+int8_t NP32_Blend_Composite(NP32_Instance_t *handle, uint16_t first, const NP32_Layer_t *layers, uint8_t layer_count,
+                            uint16_t count)
+{
+    NP32_RGB_t tmp[32];
+    const NP32_Layer_t *l;
+    uint16_t i, n;
+    uint8_t k;
+
+    for (k = 0; k < layer_count; k++)
+    {
+        l = &layers[k];
+        if (l->Pixels == NULL || l->Alpha == 0)
+            continue;
+
+        if (l->Mode == NP32_BLEND_ADD && l->Alpha != 255U)
+        {
+            // Scale the layer in chunks and add the chunks.
+            for (i = 0; i < count; i += n)
+            {
+                n = (count - i < 32U) ? count - i : 32U;
+                NP32_BlendBuf_Scale(tmp, l->Pixels + i, n, l->Alpha);
+                if (NP32_Blend_Add(handle, first + i, tmp, n) != 0)
+                    return -1;
+            }
+        }
+        else if (l->Mode == NP32_BLEND_ADD)
+        {
+            if (NP32_Blend_Add(handle, first, l->Pixels, count) != 0)
+                return -1;
+        }
+        else
+        {
+            if (_NP32_Blend_Apply(handle, first, count, _NP32_BLEND_OP_LERP, NULL, l->Pixels,
+                                  _NP32_Blend_Weight(l->Alpha)) != 0)
+                return -1;
+        }
+    }
+
+    return 0;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _NP32_Scale_Bytes(uint8_t *dst, const uint8_t *src, uint32_t n, uint16_t w)
+{
+    uint32_t i = 0;
+
+    if (w == 256U)
+    {
+        if (dst != src)
+            memmove(dst, src, n);
+        return;
+    }
+
+#if defined(_NP32_BLEND_SSE2)
+    const __m128i zero = _mm_setzero_si128(), vw = _mm_set1_epi16((int16_t) w);
+    __m128i x, lo, hi;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        x = _mm_loadu_si128((const __m128i *) (src + i));
+        lo = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(x, zero), vw), 8);
+        hi = _mm_srli_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(x, zero), vw), 8);
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(lo, hi));
+    }
+#elif defined(_NP32_BLEND_NEON)
+    const uint8x8_t vw = vdup_n_u8((uint8_t) w);
+    uint8x16_t x;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        x = vld1q_u8(src + i);
+        vst1q_u8(dst + i, vcombine_u8(vshrn_n_u16(vmull_u8(vget_low_u8(x), vw), 8),
+                                      vshrn_n_u16(vmull_u8(vget_high_u8(x), vw), 8)));
+    }
+#endif
+
+    for (; i + 4 <= n; i += 4)
+        _NP32_Store32(dst + i, _NP32_Scale4(_NP32_Load32(src + i), w));
+    for (; i < n; i++)
+        dst[i] = (uint8_t) ((src[i] * w) >> 8);
+
+    return;
+}
+
+static void _NP32_Lerp_Bytes(uint8_t *dst, const uint8_t *a, const uint8_t *b, uint32_t n, uint16_t w)
+{
+    uint32_t i = 0;
+
+    if (w == 0 || w == 256U)
+    {
+        if (dst != ((w == 0) ? a : b))
+            memmove(dst, (w == 0) ? a : b, n);
+        return;
+    }
+
+#if defined(_NP32_BLEND_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i va = _mm_set1_epi16((int16_t) (256U - w)), vb = _mm_set1_epi16((int16_t) w);
+    __m128i x, y, lo, hi;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        x = _mm_loadu_si128((const __m128i *) (a + i));
+        y = _mm_loadu_si128((const __m128i *) (b + i));
+        lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(x, zero), va),
+                           _mm_mullo_epi16(_mm_unpacklo_epi8(y, zero), vb));
+        hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(x, zero), va),
+                           _mm_mullo_epi16(_mm_unpackhi_epi8(y, zero), vb));
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_packus_epi16(_mm_srli_epi16(lo, 8), _mm_srli_epi16(hi, 8)));
+    }
+#elif defined(_NP32_BLEND_NEON)
+    // Both weights fit into a byte here (1 to 255).
+    const uint8x8_t va = vdup_n_u8((uint8_t) (256U - w)), vb = vdup_n_u8((uint8_t) w);
+    uint8x16_t x, y;
+
+    for (; i + 16 <= n; i += 16)
+    {
+        x = vld1q_u8(a + i);
+        y = vld1q_u8(b + i);
+        vst1q_u8(dst + i, vcombine_u8(vshrn_n_u16(vmlal_u8(vmull_u8(vget_low_u8(x), va), vget_low_u8(y), vb), 8),
+                                      vshrn_n_u16(vmlal_u8(vmull_u8(vget_high_u8(x), va), vget_high_u8(y), vb), 8)));
+    }
+#endif
+
+    for (; i + 4 <= n; i += 4)
+        _NP32_Store32(dst + i, _NP32_Lerp4(_NP32_Load32(a + i), _NP32_Load32(b + i), w));
+    for (; i < n; i++)
+        dst[i] = (uint8_t) (((a[i] * (256U - w)) + (b[i] * w)) >> 8);
+
+    return;
+}
+
+static void _NP32_Add_Bytes(uint8_t *dst, const uint8_t *a, const uint8_t *b, uint32_t n)
+{
+    uint32_t i = 0, s;
+
+#if defined(_NP32_BLEND_SSE2)
+    for (; i + 16 <= n; i += 16)
+    {
+        _mm_storeu_si128((__m128i *) (dst + i), _mm_adds_epu8(_mm_loadu_si128((const __m128i *) (a + i)),
+                                                              _mm_loadu_si128((const __m128i *) (b + i))));
+    }
+#elif defined(_NP32_BLEND_NEON)
+    for (; i + 16 <= n; i += 16)
+        vst1q_u8(dst + i, vqaddq_u8(vld1q_u8(a + i), vld1q_u8(b + i)));
+#endif
+
+    for (; i + 4 <= n; i += 4)
+        _NP32_Store32(dst + i, _NP32_Add4(_NP32_Load32(a + i), _NP32_Load32(b + i)));
+    for (; i < n; i++)
+    {
+        s = (uint32_t) a[i] + b[i];
+        dst[i] = (s > 255U) ? 255U : (uint8_t) s;
+    }
+
+    return;
+}
+
+static int8_t _NP32_Blend_Apply(NP32_Instance_t *handle, uint16_t first, uint16_t count, uint8_t op,
+                                const NP32_RGB_t *a, const NP32_RGB_t *b, uint16_t w)
+{
+    NP32_RGB_t *buf = handle->LED_Col_Buffer, *dst;
+    uint16_t p, n, done = 0;
+
+    if (buf == NULL || handle->_Dither_Buffer != NULL || (uint32_t) first + count > handle->LED_Count)
+        return -1;
+    if (count == 0)
+        return 0;
+
+    // The span may wrap around the end of the ring: Process it in (at most) two contiguous runs.
+    _NP32_Power_Span(handle, first, first + count - 1, 0);
+    p = _NP32_Phys(handle, first);
+    while (done < count)
+    {
+        n = handle->LED_Count - p;
+        if (n > count - done)
+            n = count - done;
+        dst = buf + p;
+
+        switch (op)
+        {
+            case _NP32_BLEND_OP_SCALE:
+                _NP32_Scale_Bytes((uint8_t *) dst, (const uint8_t *) dst, (uint32_t) n * sizeof(NP32_RGB_t), w);
+                break;
+            case _NP32_BLEND_OP_LERP:
+                // Without a, the current colours are the first buffer.
+                _NP32_Lerp_Bytes((uint8_t *) dst, (const uint8_t *) ((a != NULL) ? a + done : dst),
+                                 (const uint8_t *) (b + done), (uint32_t) n * sizeof(NP32_RGB_t), w);
+                break;
+            default:
+                _NP32_Add_Bytes((uint8_t *) dst, (const uint8_t *) dst, (const uint8_t *) (b + done),
+                                (uint32_t) n * sizeof(NP32_RGB_t));
+                break;
+        }
+
+        done += n;
+        p = 0;
+    }
+    _NP32_Power_Span(handle, first, first + count - 1, 1);
+    _NP32_Mark_Dirty(handle, first, first + count - 1);
+
+    return 0;
+}
@@ -0,0 +1,134 @@
+// neopixel32_group.c
+// Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+
+#include "neopixel32_group.h"
+#include <stddef.h>
+
+static void _NP32_Group_FrameDone(NP32_Instance_t *handle);
+
+int8_t NP32_Group_Init(NP32_Group_t *group)
+{
+    NP32_Instance_t *s;
+    uint8_t k, j, t;
+
+    if (group->Instance_Count == 0 || group->Instance_Count > NP32_GROUP_MAX_INSTANCES)
+        return -1;
+
+    for (k = 0; k < group->Instance_Count; k++)
+    {
+        s = group->Instances[k];
+        if (s == NULL || s->LED_Col_Buffer == NULL || s->_DMA_Buffer == NULL || s->_FrameDone_Hook != NULL)
+            goto error;
+
+        s->_FrameDone_Ctx = group;
+        s->_FrameDone_Hook = _NP32_Group_FrameDone;
+        group->_Done[k] = 0;
+
+        // Sort the update order by LED count (longest first), so the longest transmission starts first.
+        for (j = k; j > 0 && group->Instances[group->_Order[j - 1]]->LED_Count < s->LED_Count; j--)
+            group->_Order[j] = group->_Order[j - 1];
+        group->_Order[j] = k;
+    }
+
+    group->_Frame = 0;
+    group->Frames_Done = 0;
+
+    return 0;
+
+error:
+    // Detach from the members attached so far.
+    for (t = 0; t < k; t++)
+    {
+        group->Instances[t]->_FrameDone_Hook = NULL;
+        group->Instances[t]->_FrameDone_Ctx = NULL;
+    }
+    return -1;
+}
+
+void NP32_Group_DeInit(NP32_Group_t *group)
+{
+    uint8_t k;
+
+    // Wait for the current frame to complete.
+    while (NP32_Group_IsBusy(group));
+
+    for (k = 0; k < group->Instance_Count && k < NP32_GROUP_MAX_INSTANCES; k++)
+    {
+        if (group->Instances[k] != NULL && group->Instances[k]->_FrameDone_Ctx == group)
+        {
+            group->Instances[k]->_FrameDone_Hook = NULL;
+            group->Instances[k]->_FrameDone_Ctx = NULL;
+        }
+    }
+}
+
+int8_t NP32_Group_Update(NP32_Group_t *group)
+{
+    uint8_t k;
+
+    // Check for initialised group.
+    if (group->Instance_Count == 0 || group->Instances[0]->_FrameDone_Ctx != group)
+        return -1;
+
+    // Wait for the last frame of the group to complete.
+    while (NP32_Group_IsBusy(group));
+
+    // Start the next frame: Every member is behind from now on, until its DMA stream completes. Each member gets
+    // encoded while the members started before are transmitting.
+    group->_Frame++;
+    for (k = 0; k < group->Instance_Count; k++)
+    {
+        if (NP32_Update(group->Instances[group->_Order[k]]) != 0)
+            goto error;
+    }
+
+    return 0;
+
+error:
+    // The failed member and the members after it do not transmit this frame. Mark them done, so the group is not
+    // busy anymore once the members already started complete.
+    for (; k < group->Instance_Count; k++)
+        group->_Done[group->_Order[k]] = group->_Frame;
+    return -1;
+}
+
+uint8_t NP32_Group_IsBusy(NP32_Group_t *group)
+{
+    uint8_t k;
+
+    for (k = 0; k < group->Instance_Count; k++)
+    {
+        if (group->_Done[k] != group->_Frame)
+            return 1U;
+    }
+
+    return 0U;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _NP32_Group_FrameDone(NP32_Instance_t *handle)
+{
+    NP32_Group_t *group = (NP32_Group_t *) handle->_FrameDone_Ctx;
+    uint8_t k;
+
+    // Mark the slot of this member. Only the last member to complete sees the frame of the group as done.
+    for (k = 0; k < group->Instance_Count; k++)
+    {
+        if (group->Instances[k] == handle)
+        {
+            if (group->_Done[k] == group->_Frame)
+                return;
+            group->_Done[k] = group->_Frame;
+            break;
+        }
+    }
+    if (NP32_Group_IsBusy(group))
+        return;
+
+    group->Frames_Done++;
+    if (group->FrameComplete_Call != NULL)
+        group->FrameComplete_Call(group);
+
+    return;
+}
@@ -0,0 +1,296 @@
+// neopixel32_matrix.c
+// Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+
+#include "neopixel32_matrix.h"
+#include "neopixel32_priv.h"
+#include <stdlib.h>
+
+static uint16_t _NP32_Matrix_Layout_Index(NP32_Matrix_t *matrix, uint16_t tw, uint16_t th, uint16_t px, uint16_t py);
+static uint8_t _NP32_Matrix_Clip(NP32_Matrix_t *matrix, int16_t *x, int16_t *y, uint16_t *w, uint16_t *h,
+                                 uint16_t *skip_x, uint16_t *skip_y);
+
+// Sets the colour of the given LED and extends the span of the changed LEDs (lo to hi).
+static inline void _NP32_Matrix_Put(NP32_Instance_t *handle, uint16_t led_index, NP32_RGB_t rgb, uint16_t *lo,
+                                    uint16_t *hi)
+{
+    NP32_RGB_t *col = &handle->LED_Col_Buffer[_NP32_Phys(handle, led_index)];
+
+    _NP32_Power_Swap(handle, *col, rgb);
+    *col = rgb;
+    if (led_index < *lo)
+        *lo = led_index;
+    if (led_index > *hi)
+        *hi = led_index;
+}
+
+int8_t NP32_Matrix_Init(NP32_Matrix_t *matrix, uint16_t *map)
+{
+    uint16_t tw = matrix->Tile_Width, th = matrix->Tile_Height;
+    uint16_t x, y, px, py;
+    uint32_t pixels = NP32_MATRIX_MAP_SIZE(matrix->Width, matrix->Height);
+
+    // Not usable until initialised successfully.
+    matrix->_Map = NULL;
+    if (matrix->Instance == NULL || pixels == 0 || pixels > matrix->Instance->LED_Count || matrix->Rotation > 3)
+        return -1;
+
+    // Check the tile size. The configuration only gets changed on success.
+    if (tw == 0 || th == 0)
+    {
+        tw = matrix->Width;
+        th = matrix->Height;
+    }
+    if ((matrix->Width % tw) != 0 || (matrix->Height % th) != 0)
+        return -1;
+
+    matrix->_Alloc_Map = NULL;
+    if (map == NULL)
+    {
+        map = matrix->_Alloc_Map = (uint16_t *) malloc(pixels * sizeof(uint16_t));
+        if (map == NULL)
+            return -1;
+    }
+    matrix->_Map = map;
+    matrix->Tile_Width = tw;
+    matrix->Tile_Height = th;
+
+    // The view is turned by 90 or 270 degrees: Its rows are the columns of the panel.
+    if (matrix->Rotation & 0x01U)
+    {
+        matrix->View_Width = matrix->Height;
+        matrix->View_Height = matrix->Width;
+    }
+    else
+    {
+        matrix->View_Width = matrix->Width;
+        matrix->View_Height = matrix->Height;
+    }
+
+    // Compile the layout: Map each pixel of the view to its pixel on the panel and then to its LED index.
+    for (y = 0; y < matrix->View_Height; y++)
+    {
+        for (x = 0; x < matrix->View_Width; x++)
+        {
+            switch (matrix->Rotation)
+            {
+                case 1:
+                    px = y;
+                    py = matrix->Height - 1 - x;
+                    break;
+                case 2:
+                    px = matrix->Width - 1 - x;
+                    py = matrix->Height - 1 - y;
+                    break;
+                case 3:
+                    px = matrix->Width - 1 - y;
+                    py = x;
+                    break;
+                default:
+                    px = x;
+                    py = y;
+                    break;
+            }
+            *map++ = _NP32_Matrix_Layout_Index(matrix, tw, th, px, py);
+        }
+    }
+
+    return 0;
+}
+
+void NP32_Matrix_DeInit(NP32_Matrix_t *matrix)
+{
+    free(matrix->_Alloc_Map);
+    matrix->_Alloc_Map = NULL;
+    matrix->_Map = NULL;
+}
+
+uint16_t NP32_Matrix_Index(NP32_Matrix_t *matrix, uint16_t x, uint16_t y)
+{
+    if (matrix->_Map == NULL || x >= matrix->View_Width || y >= matrix->View_Height)
+        return 0xFFFFU;
+
+    return matrix->_Map[((uint32_t) y * matrix->View_Width) + x];
+}
+
+int8_t NP32_Matrix_SetPixel(NP32_Matrix_t *matrix, uint16_t x, uint16_t y, NP32_RGB_t rgb)
+{
+    uint16_t i = NP32_Matrix_Index(matrix, x, y);
+
+    if (i == 0xFFFFU)
+        return -1;
+
+    return NP32_SetLED_RGB(matrix->Instance, i, rgb);
+}
+
+int8_t NP32_Matrix_GetPixel(NP32_Matrix_t *matrix, uint16_t x, uint16_t y, NP32_RGB_t *rgb)
+{
+    uint16_t i = NP32_Matrix_Index(matrix, x, y);
+
+    if (i == 0xFFFFU)
+        return -1;
+
+    return NP32_GetLED_RGB(matrix->Instance, i, rgb);
+}
+
+int8_t NP32_Matrix_FillRect(NP32_Matrix_t *matrix, int16_t x, int16_t y, uint16_t w, uint16_t h, NP32_RGB_t rgb)
+{
+    NP32_Instance_t *handle = matrix->Instance;
+    const uint16_t *row;
+    uint16_t skip_x, skip_y, i, j, lo = 0xFFFFU, hi = 0;
+
+    if (matrix->_Map == NULL || handle->LED_Col_Buffer == NULL)
+        return -1;
+    if (!_NP32_Matrix_Clip(matrix, &x, &y, &w, &h, &skip_x, &skip_y))
+        return 0;
+
+    for (j = 0; j < h; j++)
+    {
+        row = matrix->_Map + ((uint32_t) (y + j) * matrix->View_Width) + x;
+        for (i = 0; i < w; i++)
+            _NP32_Matrix_Put(handle, row[i], rgb, &lo, &hi);
+    }
+    _NP32_Mark_Dirty(handle, lo, hi);
+
+    return 0;
+}
+
+int8_t NP32_Matrix_Blit(NP32_Matrix_t *matrix, int16_t x, int16_t y, const NP32_RGB_t *bitmap, uint16_t w, uint16_t h,
+                        const NP32_RGB_t *key)
+{
+    NP32_Instance_t *handle = matrix->Instance;
+    const NP32_RGB_t *src;
+    const uint16_t *row;
+    uint16_t stride = w, skip_x, skip_y, i, j, lo = 0xFFFFU, hi = 0;
+
+    if (matrix->_Map == NULL || handle->LED_Col_Buffer == NULL || bitmap == NULL)
+        return -1;
+    if (!_NP32_Matrix_Clip(matrix, &x, &y, &w, &h, &skip_x, &skip_y))
+        return 0;
+
+    for (j = 0; j < h; j++)
+    {
+        row = matrix->_Map + ((uint32_t) (y + j) * matrix->View_Width) + x;
+        src = bitmap + ((uint32_t) (skip_y + j) * stride) + skip_x;
+        if (key == NULL)
+        {
+            for (i = 0; i < w; i++)
+                _NP32_Matrix_Put(handle, row[i], src[i], &lo, &hi);
+        }
+        else
+        {
+            // Skip the transparent pixels.
+            for (i = 0; i < w; i++)
+            {
+                if (src[i].R != key->R || src[i].G != key->G || src[i].B != key->B)
+                    _NP32_Matrix_Put(handle, row[i], src[i], &lo, &hi);
+            }
+        }
+    }
+    if (lo <= hi)
+        _NP32_Mark_Dirty(handle, lo, hi);
+
+    return 0;
+}
+
+int8_t NP32_Matrix_ScrollRect(NP32_Matrix_t *matrix, uint16_t x, uint16_t y, uint16_t w, uint16_t h, int16_t dx,
+                              int16_t dy, NP32_RGB_t fill)
+{
+    NP32_Instance_t *handle = matrix->Instance;
+    NP32_RGB_t *buf = handle->LED_Col_Buffer;
+    const uint16_t *dst_row, *src_row;
+    uint16_t i, j, cx, cy, lo = 0xFFFFU, hi = 0;
+    int32_t sx, sy;
+
+    if (matrix->_Map == NULL || buf == NULL || (uint32_t) x + w > matrix->View_Width ||
+        (uint32_t) y + h > matrix->View_Height)
+        return -1;
+    if (w == 0 || h == 0 || (dx == 0 && dy == 0))
+        return 0;
+
+    // Walk the rectangle against the scroll direction, so every pixel gets read before it gets overwritten.
+    for (j = 0; j < h; j++)
+    {
+        cy = (dy > 0) ? (y + h - 1 - j) : (y + j);
+        sy = (int32_t) cy - dy;
+        dst_row = matrix->_Map + ((uint32_t) cy * matrix->View_Width);
+        src_row = (sy >= y && sy < y + h) ? matrix->_Map + ((uint32_t) sy * matrix->View_Width) : NULL;
+
+        for (i = 0; i < w; i++)
+        {
+            cx = (dx > 0) ? (x + w - 1 - i) : (x + i);
+            sx = (int32_t) cx - dx;
+
+            // Pixels, whose source lies outside of the rectangle, get scrolled in.
+            if (src_row == NULL || sx < x || sx >= x + w)
+                _NP32_Matrix_Put(handle, dst_row[cx], fill, &lo, &hi);
+            else
+                _NP32_Matrix_Put(handle, dst_row[cx], buf[_NP32_Phys(handle, src_row[sx])], &lo, &hi);
+        }
+    }
+    _NP32_Mark_Dirty(handle, lo, hi);
+
+    return 0;
+}
+
+int8_t NP32_Matrix_Scroll(NP32_Matrix_t *matrix, int16_t dx, int16_t dy, NP32_RGB_t fill)
+{
+    return NP32_Matrix_ScrollRect(matrix, 0, 0, matrix->View_Width, matrix->View_Height, dx, dy, fill);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static uint16_t _NP32_Matrix_Layout_Index(NP32_Matrix_t *matrix, uint16_t tw, uint16_t th, uint16_t px, uint16_t py)
+{
+    uint16_t tiles_x = matrix->Width / tw;
+    uint16_t tx = px / tw, ty = py / th, lx = px % tw, ly = py % th;
+    uint16_t major, minor, minor_len;
+
+    // The tiles are chained row by row, every other row reversed if serpentine.
+    if ((matrix->Layout & NP32_MATRIX_TILES_SERPENTINE) && (ty & 0x01U))
+        tx = tiles_x - 1 - tx;
+
+    // The LEDs of a tile are wired along its rows (or columns), every other one reversed if serpentine.
+    if (matrix->Layout & NP32_MATRIX_COLUMNS)
+    {
+        major = lx;
+        minor = ly;
+        minor_len = th;
+    }
+    else
+    {
+        major = ly;
+        minor = lx;
+        minor_len = tw;
+    }
+    if ((matrix->Layout & NP32_MATRIX_SERPENTINE) && (major & 0x01U))
+        minor = minor_len - 1 - minor;
+
+    return (uint16_t) ((((uint32_t) ty * tiles_x + tx) * tw * th) + ((uint32_t) major * minor_len) + minor);
+}
+
+static uint8_t _NP32_Matrix_Clip(NP32_Matrix_t *matrix, int16_t *x, int16_t *y, uint16_t *w, uint16_t *h,
+                                 uint16_t *skip_x, uint16_t *skip_y)
+{
+    int32_t x0 = *x, y0 = *y, x1 = (int32_t) *x + *w, y1 = (int32_t) *y + *h;
+
+    // Clip the rectangle to the view, skip_x and skip_y give the count of clipped columns and rows at the top-left.
+    if (x0 < 0)
+        x0 = 0;
+    if (y0 < 0)
+        y0 = 0;
+    if (x1 > matrix->View_Width)
+        x1 = matrix->View_Width;
+    if (y1 > matrix->View_Height)
+        y1 = matrix->View_Height;
+    if (x0 >= x1 || y0 >= y1)
+        return 0U;
+
+    *skip_x = (uint16_t) (x0 - *x);
+    *skip_y = (uint16_t) (y0 - *y);
+    *x = (int16_t) x0;
+    *y = (int16_t) y0;
+    *w = (uint16_t) (x1 - x0);
+    *h = (uint16_t) (y1 - y0);
+
+    return 1U;
+}
@@ -0,0 +1,261 @@
+// neopixel32_parallel.c
+// Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+
+#include "neopixel32_parallel.h"
+#include "neopixel32_priv.h"
+#include <stdlib.h>
+
+static void _NP32_Parallel_Encode(NP32_Parallel_t *group, uint16_t first, uint16_t count);
+static void _NP32_Parallel_Recalc_Plane_Buf(NP32_Parallel_t *group);
+static void _NP32_Parallel_Free_Strips(NP32_Parallel_t *group, uint8_t count);
+
+// Transposes the 8x8 bit matrix held in x (rows 0 to 3) and y (rows 4 to 7). [Hacker's Delight, transpose8]
+static inline void _NP32_Transpose8(uint32_t *x, uint32_t *y)
+{
+    uint32_t t;
+
+    t = (*x ^ (*x >> 7)) & 0x00AA00AAUL;
+    *x = *x ^ t ^ (t << 7);
+    t = (*y ^ (*y >> 7)) & 0x00AA00AAUL;
+    *y = *y ^ t ^ (t << 7);
+
+    t = (*x ^ (*x >> 14)) & 0x0000CCCCUL;
+    *x = *x ^ t ^ (t << 14);
+    t = (*y ^ (*y >> 14)) & 0x0000CCCCUL;
+    *y = *y ^ t ^ (t << 14);
+
+    t = (*x & 0xF0F0F0F0UL) | ((*y >> 4) & 0x0F0F0F0FUL);
+    *y = ((*x << 4) & 0xF0F0F0F0UL) | (*y & 0x0F0F0F0FUL);
+    *x = t;
+}
+
+int8_t NP32_Parallel_Init(NP32_Parallel_t *group)
+{
+    NP32_Instance_t *s;
+    uint8_t k;
+
+    if (group->Strip_Count == 0 || group->Strip_Count > NP32_PARALLEL_MAX_STRIPS || group->StartDMA_Call == NULL)
+        return -1;
+
+    // Check the members and find the longest strip.
+    group->_LED_Count = 0;
+    for (k = 0; k < group->Strip_Count; k++)
+    {
+        s = group->Strips[k];
+        if (s == NULL || s->LED_Count == 0 || s->Format != NP32_FORMAT_GRB)
+            return -1;
+        if (s->LED_Count > group->_LED_Count)
+            group->_LED_Count = s->LED_Count;
+    }
+
+    // The plane count has to fit the DMA length.
+    if (((uint32_t) group->_LED_Count * NP32_WS2812_PERIODS_PER_LED) > 0xFFFFUL)
+        return -1;
+
+    // Allocate the colour buffers of the members. The members have no DMA buffer, the group encodes into the plane
+    // buffer.
+    for (k = 0; k < group->Strip_Count; k++)
+    {
+        s = group->Strips[k];
+        s->LED_Col_Buffer = (NP32_RGB_t *) calloc(s->LED_Count, sizeof(NP32_RGB_t));
+        if (s->LED_Col_Buffer == NULL)
+        {
+            _NP32_Parallel_Free_Strips(group, k);
+            return -1;
+        }
+        s->_DMA_Buffer = NULL;
+        s->_Static_Flags = 0U;
+        s->_Col_LUT_Buffer = NULL;
+        s->_Alloc_Col_Buffer = s->LED_Col_Buffer;
+        _NP32_Reset_State(s);
+    }
+
+    group->_Plane_Buffer = (uint16_t *) calloc(group->_LED_Count * NP32_WS2812_PERIODS_PER_LED, sizeof(uint16_t));
+    if (group->_Plane_Buffer == NULL)
+    {
+        _NP32_Parallel_Free_Strips(group, group->Strip_Count);
+        return -1;
+    }
+
+    group->Pin_Mask = (uint16_t) ((1UL << group->Strip_Count) - 1);
+    group->DMA_Busy_Flag = 0U;
+
+    return 0;
+}
+
+void NP32_Parallel_DeInit(NP32_Parallel_t *group)
+{
+    _NP32_Parallel_Free_Strips(group, (group->Strip_Count < NP32_PARALLEL_MAX_STRIPS) ? group->Strip_Count :
+                                                                                         NP32_PARALLEL_MAX_STRIPS);
+
+    free(group->_Plane_Buffer);
+    group->_Plane_Buffer = NULL;
+    group->_LED_Count = 0;
+}
+
+int8_t NP32_Parallel_Update(NP32_Parallel_t *group)
+{
+    // Check for initialised group.
+    if (group->_Plane_Buffer == NULL)
+        return -1;
+
+    // Wait for the last update to complete.
+    while (group->DMA_Busy_Flag);
+
+    _NP32_Parallel_Recalc_Plane_Buf(group);
+
+    // Start the DMA stream to the GPIO port.
+    group->DMA_Busy_Flag = 1U;
+    group->StartDMA_Call(group->_Plane_Buffer, group->_LED_Count * NP32_WS2812_PERIODS_PER_LED);
+
+    return 0;
+}
+
+void NP32_Parallel_DMAComplete_Callback(NP32_Parallel_t *group)
+{
+    if (!group->DMA_Busy_Flag)
+        return;
+
+    group->DMA_Busy_Flag = 0;
+
+    if (group->FrameComplete_Call != NULL)
+        group->FrameComplete_Call(group);
+}
+
+void NP32_Parallel_Transpose8(const uint8_t *in, uint8_t *out)
+{
+    uint32_t x, y;
+
+    x = ((uint32_t) in[0] << 24) | ((uint32_t) in[1] << 16) | ((uint32_t) in[2] << 8) | in[3];
+    y = ((uint32_t) in[4] << 24) | ((uint32_t) in[5] << 16) | ((uint32_t) in[6] << 8) | in[7];
+
+    _NP32_Transpose8(&x, &y);
+
+    out[0] = x >> 24; out[1] = x >> 16; out[2] = x >> 8; out[3] = x;
+    out[4] = y >> 24; out[5] = y >> 16; out[6] = y >> 8; out[7] = y;
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _NP32_Parallel_Encode(NP32_Parallel_t *group, uint16_t first, uint16_t count)
+{
+    NP32_Instance_t *s;
+    NP32_RGB_t col;
+    uint8_t bytes[3][NP32_PARALLEL_MAX_STRIPS];
+    uint16_t *dst = group->_Plane_Buffer + (first * NP32_WS2812_PERIODS_PER_LED);
+    uint16_t i, mask = group->Pin_Mask;
+    uint32_t xl, yl, xh, yh;
+    uint8_t k, c;
+
+    for (k = group->Strip_Count; k < NP32_PARALLEL_MAX_STRIPS; k++)
+        bytes[0][k] = bytes[1][k] = bytes[2][k] = 0;
+
+    for (i = first; i < first + count; i++)
+    {
+        // Gather the colour bytes of LED i of all strips in the order they are sent. Strips shorter than the group
+        // send black beyond their end.
+        for (k = 0; k < group->Strip_Count; k++)
+        {
+            s = group->Strips[k];
+            col = (i < s->LED_Count) ? _NP32_Load_Col(s, i) : NP32_COL_BLACK;
+            bytes[0][k] = col.G;
+            bytes[1][k] = col.R;
+            bytes[2][k] = col.B;
+        }
+
+        // Transpose the bytes of strips 7..0 and 15..8, so row j holds bit (7 - j) of every strip, then store the
+        // inverted rows as the masks of the strips sending a 0 bit.
+        for (c = 0; c < 3; c++)
+        {
+            xl = ((uint32_t) bytes[c][7] << 24) | ((uint32_t) bytes[c][6] << 16) | ((uint32_t) bytes[c][5] << 8) |
+                 bytes[c][4];
+            yl = ((uint32_t) bytes[c][3] << 24) | ((uint32_t) bytes[c][2] << 16) | ((uint32_t) bytes[c][1] << 8) |
+                 bytes[c][0];
+            _NP32_Transpose8(&xl, &yl);
+
+            if (group->Strip_Count > 8)
+            {
+                xh = ((uint32_t) bytes[c][15] << 24) | ((uint32_t) bytes[c][14] << 16) |
+                     ((uint32_t) bytes[c][13] << 8) | bytes[c][12];
+                yh = ((uint32_t) bytes[c][11] << 24) | ((uint32_t) bytes[c][10] << 16) |
+                     ((uint32_t) bytes[c][9] << 8) | bytes[c][8];
+                _NP32_Transpose8(&xh, &yh);
+            }
+            else
+            {
+                xh = yh = 0;
+            }
+
+            dst[0] = ~(((xh >> 16) & 0xFF00) | (xl >> 24)) & mask;
+            dst[1] = ~(((xh >> 8) & 0xFF00) | ((xl >> 16) & 0xFF)) & mask;
+            dst[2] = ~((xh & 0xFF00) | ((xl >> 8) & 0xFF)) & mask;
+            dst[3] = ~(((xh << 8) & 0xFF00) | (xl & 0xFF)) & mask;
+            dst[4] = ~(((yh >> 16) & 0xFF00) | (yl >> 24)) & mask;
+            dst[5] = ~(((yh >> 8) & 0xFF00) | ((yl >> 16) & 0xFF)) & mask;
+            dst[6] = ~((yh & 0xFF00) | ((yl >> 8) & 0xFF)) & mask;
+            dst[7] = ~(((yh << 8) & 0xFF00) | (yl & 0xFF)) & mask;
+            dst += 8;
+        }
+    }
+}
+
+static void _NP32_Parallel_Recalc_Plane_Buf(NP32_Parallel_t *group)
+{
+    NP32_Instance_t *s;
+    uint16_t low = 0xFFFFU, high = 0;
+    uint8_t k;
+
+    // Collect the union of the dirty spans of all members. Toggling the disable mode of a member re-encodes all LEDs.
+    for (k = 0; k < group->Strip_Count; k++)
+    {
+        s = group->Strips[k];
+        if (s->LED_Disable_Flag != s->_Encoded_Disable_Flag)
+        {
+            s->_Encoded_Disable_Flag = s->LED_Disable_Flag;
+            _NP32_Mark_All_Dirty(s);
+        }
+        if (s->_Dirty_Low <= s->_Dirty_High)
+        {
+            if (s->_Dirty_Low < low)
+                low = s->_Dirty_Low;
+            if (s->_Dirty_High > high)
+                high = s->_Dirty_High;
+        }
+
+        // Clear the dirty span.
+        s->_Dirty_Low = 0xFFFFU;
+        s->_Dirty_High = 0;
+    }
+
+    if (low <= high)
+        _NP32_Parallel_Encode(group, low, high - low + 1);
+}
+
+static void _NP32_Parallel_Free_Strips(NP32_Parallel_t *group, uint8_t count)
+{
+    NP32_Instance_t *s;
+    uint8_t k;
+
+    // Free the buffers allocated for the first count members. An attached frame is owned by the caller.
+    for (k = 0; k < count; k++)
+    {
+        s = group->Strips[k];
+        if (s == NULL)
+            continue;
+        free(s->_Alloc_Col_Buffer);
+        free(s->_Alloc_Back_Buffer);
+        free(s->_Alloc_Dither_Buffer);
+        free(s->_Col_LUT_Buffer);
+        s->LED_Col_Buffer = NULL;
+        s->_Back_Buffer = NULL;
+        s->_Alloc_Col_Buffer = NULL;
+        s->_Alloc_Back_Buffer = NULL;
+        s->_Dither_Buffer = NULL;
+        s->_Dither_Err = NULL;
+        s->_Alloc_Dither_Buffer = NULL;
+        s->_Col_LUT_Buffer = NULL;
+        s->_Col_LUT = NULL;
+    }
+
+    return;
+}
@@ -0,0 +1,147 @@
+// neopixel32_priv.h
+// Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+//
+// Internal helpers shared by the modules of libneopixel32. Not part of the public interface.
+
+#if !defined(__NEOPIXEL32_PRIV_H)
+#define __NEOPIXEL32_PRIV_H
+
+#include <stddef.h>
+#include "neopixel32.h"
+
+// Flags of NP32_Instance_t::_Static_Flags.
+#define _NP32_STATIC_BUFFERS        0x01U   // Colour and DMA buffer are owned by the caller.
+#define _NP32_STATIC_COL_LUT        0x02U   // The memory of the colour correction table is owned by the caller.
+
+// Sets the private state of an instance with allocated buffers to its initial values (no colour correction, no power
+// limit, full encode at the first update). Defined in neopixel32.c.
+void _NP32_Reset_State(NP32_Instance_t *handle);
+
+// Swaps the front and the back buffer like NP32_Commit, but only marks the LEDs from index lower_bound to index
+// higher_bound as dirty (none if lower_bound > higher_bound). All other LEDs of the back buffer have to equal the ones
+// of the front buffer, so only the span gets counted for the channel sums of the power limiter. Defined in
+// neopixel32.c.
+int8_t _NP32_Commit_Span(NP32_Instance_t *handle, uint16_t lower_bound, uint16_t higher_bound);
+
+static inline void _NP32_Mark_Dirty(NP32_Instance_t *handle, uint16_t lower_bound, uint16_t higher_bound)
+{
+    if (lower_bound < handle->_Dirty_Low)
+        handle->_Dirty_Low = lower_bound;
+    if (higher_bound > handle->_Dirty_High)
+        handle->_Dirty_High = higher_bound;
+}
+
+static inline void _NP32_Mark_All_Dirty(NP32_Instance_t *handle)
+{
+    handle->_Dirty_Low = 0;
+    handle->_Dirty_High = handle->LED_Count - 1;
+}
+
+// Maps the (logical) index of an LED to its index in the colour buffer, which is a ring starting at _Ring_Offset.
+static inline uint16_t _NP32_Phys(const NP32_Instance_t *handle, uint16_t led_index)
+{
+    uint32_t p = (uint32_t) led_index + handle->_Ring_Offset;
+
+    return (uint16_t) ((p >= handle->LED_Count) ? p - handle->LED_Count : p);
+}
+
+// Updates the running channel sums of the power limiter for an LED changing from colour old to colour rgb. The sums
+// are only kept while the limiter is enabled. Unsigned arithmetic, the sums never drop below 0.
+static inline void _NP32_Power_Swap(NP32_Instance_t *handle, NP32_RGB_t old, NP32_RGB_t rgb)
+{
+    if (handle->_Power_Budget_mA == 0)
+        return;
+
+    handle->_Power_Sum[0] += (uint32_t) rgb.R - old.R;
+    handle->_Power_Sum[1] += (uint32_t) rgb.G - old.G;
+    handle->_Power_Sum[2] += (uint32_t) rgb.B - old.B;
+}
+
+// Adds (add = 1) or removes (add = 0) the colours of the LEDs from index lower_bound to index higher_bound, which may
+// wrap around the end of the ring, to / from the running channel sums of the power limiter. Called with add = 0 before
+// and add = 1 after overwriting the span.
+static inline void _NP32_Power_Span(NP32_Instance_t *handle, uint16_t lower_bound, uint16_t higher_bound, uint8_t add)
+{
+    const NP32_RGB_t *buf = handle->LED_Col_Buffer;
+    uint16_t p, n = higher_bound - lower_bound + 1;
+    uint32_t r = 0, g = 0, b = 0;
+
+    if (handle->_Power_Budget_mA == 0)
+        return;
+
+    p = _NP32_Phys(handle, lower_bound);
+    while (n-- > 0)
+    {
+        r += buf[p].R;
+        g += buf[p].G;
+        b += buf[p].B;
+        if (++p == handle->LED_Count)
+            p = 0;
+    }
+
+    if (add)
+    {
+        handle->_Power_Sum[0] += r;
+        handle->_Power_Sum[1] += g;
+        handle->_Power_Sum[2] += b;
+    }
+    else
+    {
+        handle->_Power_Sum[0] -= r;
+        handle->_Power_Sum[1] -= g;
+        handle->_Power_Sum[2] -= b;
+    }
+}
+
+// Sets the colour of the LEDs from index lower_bound to index higher_bound, which may wrap around the end of the ring.
+static inline void _NP32_Fill(NP32_Instance_t *handle, uint16_t lower_bound, uint16_t higher_bound, NP32_RGB_t rgb)
+{
+    NP32_RGB_t *buf = handle->LED_Col_Buffer;
+    uint16_t p = _NP32_Phys(handle, lower_bound);
+    uint16_t n = higher_bound - lower_bound + 1;
+
+    // The new colours of the span are known, only the old ones have to be removed from the channel sums.
+    if (handle->_Power_Budget_mA != 0)
+    {
+        _NP32_Power_Span(handle, lower_bound, higher_bound, 0);
+        handle->_Power_Sum[0] += (uint32_t) n * rgb.R;
+        handle->_Power_Sum[1] += (uint32_t) n * rgb.G;
+        handle->_Power_Sum[2] += (uint32_t) n * rgb.B;
+    }
+
+    while (n-- > 0)
+    {
+        buf[p] = rgb;
+        if (++p == handle->LED_Count)
+            p = 0;
+    }
+}
+
+// Gets the colour at the given index of the colour buffer as it has to be sent: Black in the LED disable mode,
+// otherwise the colour from the colour buffer with the colour correction of the instance applied.
+static inline NP32_RGB_t _NP32_Load_Col_Phys(const NP32_Instance_t *handle, uint16_t buf_index)
+{
+    NP32_RGB_t col;
+    const uint8_t *lut = handle->_Col_LUT;
+
+    if (handle->LED_Disable_Flag == 1U)
+        return NP32_COL_BLACK;
+
+    col = handle->LED_Col_Buffer[buf_index];
+    if (lut != NULL)
+    {
+        col.R = lut[col.R];
+        col.G = lut[256 + col.G];
+        col.B = lut[512 + col.B];
+    }
+
+    return col;
+}
+
+// Gets the colour of the given LED as it has to be sent.
+static inline NP32_RGB_t _NP32_Load_Col(const NP32_Instance_t *handle, uint16_t led_index)
+{
+    return _NP32_Load_Col_Phys(handle, _NP32_Phys(handle, led_index));
+}
+
+#endif // __NEOPIXEL32_PRIV_H
@@ -0,0 +1,269 @@
+// neopixel32_seq.c
+// Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+
+#include "neopixel32_seq.h"
+#include "neopixel32_priv.h"
+
+#define _NP32_SEQ_SKIP_MAX      127U    // Maximum count of LEDs skipped by a single code.
+#define _NP32_SEQ_RUN_MAX       64U     // Maximum count of LEDs of a single literal or repeat code.
+#define _NP32_SEQ_LITERAL       0x80U
+#define _NP32_SEQ_REPEAT        0xC0U
+
+static void _NP32_Seq_Copy(NP32_Instance_t *handle, uint16_t led_index, const uint8_t *src, uint16_t count);
+static uint32_t _NP32_Seq_Skip(const NP32_Seq_t *seq, uint32_t pos);
+
+static inline uint16_t _NP32_Seq_Read16(const uint8_t *p)
+{
+    return (uint16_t) (p[0] | ((uint16_t) p[1] << 8));
+}
+
+static inline uint8_t _NP32_Seq_Col_Eq(NP32_RGB_t a, NP32_RGB_t b)
+{
+    return a.R == b.R && a.G == b.G && a.B == b.B;
+}
+
+int8_t NP32_Seq_Init(NP32_Seq_t *seq)
+{
+    const uint8_t *d = seq->Data;
+
+    if (seq->Instance == NULL || seq->Instance->LED_Col_Buffer == NULL || d == NULL ||
+        seq->Size < NP32_SEQ_HEADER_SIZE)
+        return -1;
+    if (d[0] != 'N' || d[1] != 'P' || d[2] != '3' || d[3] != '2' || d[4] != NP32_SEQ_VERSION)
+        return -1;
+
+    seq->LED_Count = _NP32_Seq_Read16(&d[6]);
+    seq->Frame_Count = _NP32_Seq_Read16(&d[8]);
+    if (seq->LED_Count == 0 || seq->LED_Count > seq->Instance->LED_Count)
+        return -1;
+
+    NP32_Seq_Rewind(seq);
+
+    return 0;
+}
+
+void NP32_Seq_Rewind(NP32_Seq_t *seq)
+{
+    seq->Frame = 0;
+    seq->Duration_ms = 0;
+    seq->_Pos = NP32_SEQ_HEADER_SIZE;
+}
+
+int8_t NP32_Seq_Next(NP32_Seq_t *seq)
+{
+    NP32_Instance_t *handle = seq->Instance;
+    const uint8_t *d = seq->Data;
+    uint32_t pos = seq->_Pos, end = seq->Size;
+    uint16_t i = 0, n, lo = 0xFFFFU, hi = 0;
+    int8_t status = -1;
+    uint8_t code;
+
+    if (seq->Frame >= seq->Frame_Count)
+        return 0;
+    if (pos + 3 > end)
+        return -1;
+
+    seq->Duration_ms = _NP32_Seq_Read16(&d[pos + 1]);
+    pos += 3;
+
+    while (pos < end)
+    {
+        code = d[pos++];
+        if (code == 0x00U)
+        {
+            status = 1;
+            break;
+        }
+
+        // Skip the unchanged LEDs.
+        if (code < _NP32_SEQ_LITERAL)
+        {
+            i += code;
+            if (i > seq->LED_Count)
+                break;
+            continue;
+        }
+
+        n = (code & (_NP32_SEQ_RUN_MAX - 1U)) + 1U;
+        if ((uint32_t) i + n > seq->LED_Count)
+            break;
+        if (code & 0x40U)
+        {
+            if (pos + 3 > end)
+                break;
+            _NP32_Fill(handle, i, i + n - 1, (NP32_RGB_t){ d[pos], d[pos + 1], d[pos + 2] });
+            pos += 3;
+        }
+        else
+        {
+            if (pos + (3UL * n) > end)
+                break;
+            _NP32_Seq_Copy(handle, i, &d[pos], n);
+            pos += 3UL * n;
+        }
+
+        if (i < lo)
+            lo = i;
+        hi = i + n - 1;
+        i += n;
+    }
+
+    if (lo <= hi)
+        _NP32_Mark_Dirty(handle, lo, hi);
+    if (status != 1)
+        return -1;
+
+    seq->_Pos = pos;
+    seq->Frame++;
+
+    return 1;
+}
+
+int8_t NP32_Seq_Seek(NP32_Seq_t *seq, uint16_t frame)
+{
+    const uint8_t *d = seq->Data;
+    uint32_t pos = NP32_SEQ_HEADER_SIZE, key_pos = 0;
+    uint16_t f, key = 0;
+
+    if (frame >= seq->Frame_Count)
+        return -1;
+
+    // Find the last keyframe up to the frame by skipping over the codes of the frames before.
+    for (f = 0; f <= frame; f++)
+    {
+        if (pos + 3 > seq->Size)
+            return -1;
+        if (d[pos] & NP32_SEQ_KEYFRAME)
+        {
+            key = f;
+            key_pos = pos;
+        }
+        if (f < frame && (pos = _NP32_Seq_Skip(seq, pos)) == 0)
+            return -1;
+    }
+    if (key_pos == 0)
+        return -1;
+
+    // Decode from the keyframe up to the frame.
+    seq->Frame = key;
+    seq->_Pos = key_pos;
+    while (seq->Frame <= frame)
+    {
+        if (NP32_Seq_Next(seq) != 1)
+            return -1;
+    }
+
+    return 0;
+}
+
+void NP32_Seq_EncodeHeader(uint8_t *out, uint16_t led_count, uint16_t frame_count)
+{
+    out[0] = 'N';
+    out[1] = 'P';
+    out[2] = '3';
+    out[3] = '2';
+    out[4] = NP32_SEQ_VERSION;
+    out[5] = 0;
+    out[6] = (uint8_t) led_count;
+    out[7] = (uint8_t) (led_count >> 8);
+    out[8] = (uint8_t) frame_count;
+    out[9] = (uint8_t) (frame_count >> 8);
+}
+
+uint32_t NP32_Seq_EncodeFrame(const NP32_RGB_t *prev, const NP32_RGB_t *cur, uint16_t led_count, uint16_t duration_ms,
+                              uint8_t *out)
+{
+    uint8_t *p = out;
+    uint16_t i = 0, j, n;
+
+    *p++ = (prev == NULL) ? NP32_SEQ_KEYFRAME : 0;
+    *p++ = (uint8_t) duration_ms;
+    *p++ = (uint8_t) (duration_ms >> 8);
+
+    while (i < led_count)
+    {
+        // Unchanged LEDs get skipped, trailing ones are covered by the end code.
+        if (prev != NULL && _NP32_Seq_Col_Eq(prev[i], cur[i]))
+        {
+            for (j = i + 1; j < led_count && _NP32_Seq_Col_Eq(prev[j], cur[j]); j++);
+            if (j == led_count)
+                break;
+            for (n = j - i; n > _NP32_SEQ_SKIP_MAX; n -= _NP32_SEQ_SKIP_MAX)
+                *p++ = _NP32_SEQ_SKIP_MAX;
+            *p++ = (uint8_t) n;
+            i = j;
+            continue;
+        }
+
+        // A run of at least 2 equal colours gets repeated.
+        for (j = i + 1; j < led_count && j - i < _NP32_SEQ_RUN_MAX && _NP32_Seq_Col_Eq(cur[j], cur[i]); j++);
+        if (j - i >= 2)
+        {
+            *p++ = (uint8_t) (_NP32_SEQ_REPEAT | (j - i - 1));
+            *p++ = cur[i].R;
+            *p++ = cur[i].G;
+            *p++ = cur[i].B;
+            i = j;
+            continue;
+        }
+
+        // Collect literal colours up to the next unchanged LED or run.
+        for (j = i + 1; j < led_count && j - i < _NP32_SEQ_RUN_MAX; j++)
+        {
+            if (prev != NULL && _NP32_Seq_Col_Eq(prev[j], cur[j]))
+                break;
+            if (j + 1 < led_count && _NP32_Seq_Col_Eq(cur[j], cur[j + 1]))
+                break;
+        }
+        *p++ = (uint8_t) (_NP32_SEQ_LITERAL | (j - i - 1));
+        for (; i < j; i++)
+        {
+            *p++ = cur[i].R;
+            *p++ = cur[i].G;
+            *p++ = cur[i].B;
+        }
+    }
+    *p++ = 0x00U;
+
+    return (uint32_t) (p - out);
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void _NP32_Seq_Copy(NP32_Instance_t *handle, uint16_t led_index, const uint8_t *src, uint16_t count)
+{
+    NP32_RGB_t *buf = handle->LED_Col_Buffer;
+    uint16_t p = _NP32_Phys(handle, led_index), n = count;
+
+    _NP32_Power_Span(handle, led_index, led_index + count - 1, 0);
+    while (n-- > 0)
+    {
+        buf[p] = (NP32_RGB_t){ src[0], src[1], src[2] };
+        src += 3;
+        if (++p == handle->LED_Count)
+            p = 0;
+    }
+    _NP32_Power_Span(handle, led_index, led_index + count - 1, 1);
+
+    return;
+}
+
+// Returns the offset of the frame following the frame at offset pos, or 0 if the frame is truncated.
+static uint32_t _NP32_Seq_Skip(const NP32_Seq_t *seq, uint32_t pos)
+{
+    const uint8_t *d = seq->Data;
+    uint8_t code;
+
+    pos += 3;
+    while (pos < seq->Size)
+    {
+        code = d[pos++];
+        if (code == 0x00U)
+            return pos;
+        if (code < _NP32_SEQ_LITERAL)
+            continue;
+        pos += (code & 0x40U) ? 3UL : 3UL * ((code & (_NP32_SEQ_RUN_MAX - 1U)) + 1U);
+    }
+
+    return 0;
+}
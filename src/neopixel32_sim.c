@@ -0,0 +1,362 @@
+// neopixel32_sim.c
+// Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+
+#include "neopixel32_sim.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static NP32_Sim_t *_NP32_Sim_Channels[NP32_SIM_MAX_CHANNELS];
+static pthread_mutex_t _NP32_Sim_Channels_Lock = PTHREAD_MUTEX_INITIALIZER;
+
+// The channel, whose simulation thread is currently executing a DMA callback. Used by the stop delegate, which does
+// not get any reference to its channel.
+static __thread NP32_Sim_t *_NP32_Sim_Current;
+
+static void *_NP32_Sim_Thread(void *arg);
+static void _NP32_Sim_Run_Single(NP32_Sim_t *sim, NP32_DMA_t *buf, uint16_t len);
+static void _NP32_Sim_Run_Circular(NP32_Sim_t *sim, NP32_DMA_t *buf, uint16_t len);
+static void _NP32_Sim_Decode_Units(NP32_Sim_t *sim, NP32_Sim_Decoder_t *dec, const uint8_t *buf, uint32_t units);
+static uint32_t _NP32_Sim_Unit_ns(NP32_Sim_t *sim);
+static uint64_t _NP32_Sim_Now(void);
+static void _NP32_Sim_Sleep_Until(uint64_t deadline);
+
+int8_t NP32_Sim_Attach(NP32_Sim_t *sim, NP32_Instance_t *handle)
+{
+    uint8_t i;
+
+    if (handle->LED_Count == 0)
+        return -1;
+
+    memset(sim, 0, sizeof(NP32_Sim_t));
+    sim->Instance = handle;
+    sim->Period_ns = NP32_SIM_PERIOD_NS;
+    sim->Frame_GRB = (uint8_t *) calloc(handle->LED_Count, NP32_FORMAT_BYTES(handle->Format));
+    if (sim->Frame_GRB == NULL)
+        return -1;
+
+    // Register the channel, so the start delegate can find it by the DMA buffer.
+    pthread_mutex_lock(&_NP32_Sim_Channels_Lock);
+    for (i = 0; i < NP32_SIM_MAX_CHANNELS; i++)
+    {
+        if (_NP32_Sim_Channels[i] == NULL)
+        {
+            _NP32_Sim_Channels[i] = sim;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&_NP32_Sim_Channels_Lock);
+    if (i == NP32_SIM_MAX_CHANNELS)
+    {
+        free(sim->Frame_GRB);
+        return -1;
+    }
+
+    pthread_mutex_init(&sim->_Lock, NULL);
+    pthread_cond_init(&sim->_Cond, NULL);
+    if (pthread_create(&sim->_Thread, NULL, _NP32_Sim_Thread, sim) != 0)
+    {
+        // No thread to join, the handle is undefined: Undo the registration only.
+        pthread_mutex_lock(&_NP32_Sim_Channels_Lock);
+        _NP32_Sim_Channels[i] = NULL;
+        pthread_mutex_unlock(&_NP32_Sim_Channels_Lock);
+        pthread_cond_destroy(&sim->_Cond);
+        pthread_mutex_destroy(&sim->_Lock);
+        free(sim->Frame_GRB);
+        sim->Frame_GRB = NULL;
+        return -1;
+    }
+
+    handle->StartDMA_Call = NP32_Sim_StartDMA;
+    handle->StopDMA_Call = NP32_Sim_StopDMA;
+
+    return 0;
+}
+
+void NP32_Sim_Detach(NP32_Sim_t *sim)
+{
+    uint8_t i;
+
+    // Stop the simulation thread.
+    pthread_mutex_lock(&sim->_Lock);
+    sim->_Quit = 1U;
+    pthread_cond_signal(&sim->_Cond);
+    pthread_mutex_unlock(&sim->_Lock);
+    if (sim->_Thread)
+        pthread_join(sim->_Thread, NULL);
+
+    pthread_mutex_lock(&_NP32_Sim_Channels_Lock);
+    for (i = 0; i < NP32_SIM_MAX_CHANNELS; i++)
+    {
+        if (_NP32_Sim_Channels[i] == sim)
+            _NP32_Sim_Channels[i] = NULL;
+    }
+    pthread_mutex_unlock(&_NP32_Sim_Channels_Lock);
+
+    pthread_cond_destroy(&sim->_Cond);
+    pthread_mutex_destroy(&sim->_Lock);
+    free(sim->Frame_GRB);
+    sim->Frame_GRB = NULL;
+}
+
+void NP32_Sim_WaitIdle(NP32_Sim_t *sim)
+{
+    struct timespec ts = { 0, 10000 };
+
+    while (sim->Instance->DMA_Busy_Flag || sim->_Start)
+        nanosleep(&ts, NULL);
+}
+
+int8_t NP32_Sim_StartDMA(NP32_DMA_t *buf, uint16_t len)
+{
+    NP32_Sim_t *sim = NULL;
+    uint8_t i;
+
+    pthread_mutex_lock(&_NP32_Sim_Channels_Lock);
+    for (i = 0; i < NP32_SIM_MAX_CHANNELS; i++)
+    {
+        if (_NP32_Sim_Channels[i] != NULL && _NP32_Sim_Channels[i]->Instance->_DMA_Buffer == buf)
+        {
+            sim = _NP32_Sim_Channels[i];
+            break;
+        }
+    }
+    pthread_mutex_unlock(&_NP32_Sim_Channels_Lock);
+    if (sim == NULL)
+        return -1;
+
+    pthread_mutex_lock(&sim->_Lock);
+    sim->_Buf = buf;
+    sim->_Len = len;
+    sim->_Stop = 0U;
+    sim->_Start = 1U;
+    pthread_cond_signal(&sim->_Cond);
+    pthread_mutex_unlock(&sim->_Lock);
+
+    return 0;
+}
+
+int8_t NP32_Sim_StopDMA(void)
+{
+    if (_NP32_Sim_Current == NULL)
+        return -1;
+
+    _NP32_Sim_Current->_Stop = 1U;
+    _NP32_Sim_Current->Frames_Sent++;
+
+    return 0;
+}
+
+void NP32_Sim_Decoder_Reset(NP32_Sim_Decoder_t *dec, uint8_t *out, uint32_t out_size)
+{
+    memset(dec, 0, sizeof(NP32_Sim_Decoder_t));
+    dec->Out = out;
+    dec->Out_Size = out_size;
+    dec->Threshold = (NP32_WS2812_0_TIME + NP32_WS2812_1_TIME) / 2;
+}
+
+void NP32_Sim_Decode(NP32_Sim_Decoder_t *dec, const NP32_DMA_t *buf, uint32_t len)
+{
+    uint32_t i;
+
+    for (i = 0; i < len; i++)
+    {
+        // A zero period keeps the data line low: Reset period.
+        if (buf[i] == 0)
+        {
+            dec->Reset_Periods++;
+            dec->_Bits = 0;
+            continue;
+        }
+        dec->Reset_Periods = 0;
+
+        dec->_Byte = (dec->_Byte << 1) | (buf[i] > dec->Threshold ? 1U : 0U);
+        if (++dec->_Bits == 8)
+        {
+            if (dec->Out_Count < dec->Out_Size)
+                dec->Out[dec->Out_Count] = dec->_Byte;
+            dec->Out_Count++;
+            dec->_Bits = 0;
+        }
+    }
+}
+
+void NP32_Sim_Decode_SPI(NP32_Sim_Decoder_t *dec, const uint8_t *buf, uint32_t len, uint8_t symbol_bits)
+{
+    uint32_t i;
+    uint8_t b;
+
+    for (i = 0; i < len; i++)
+    {
+        for (b = 8; b > 0; b--)
+        {
+            dec->_Sym = (dec->_Sym << 1) | ((buf[i] >> (b - 1)) & 0x01);
+            if (++dec->_Sym_Bits < symbol_bits)
+                continue;
+
+            // A complete symbol: Zero symbols are reset periods, otherwise its second bit carries the data.
+            if (dec->_Sym == 0)
+            {
+                dec->Reset_Periods++;
+                dec->_Bits = 0;
+            }
+            else
+            {
+                dec->Reset_Periods = 0;
+                dec->_Byte = (dec->_Byte << 1) | ((dec->_Sym >> (symbol_bits - 2)) & 0x01);
+                if (++dec->_Bits == 8)
+                {
+                    if (dec->Out_Count < dec->Out_Size)
+                        dec->Out[dec->Out_Count] = dec->_Byte;
+                    dec->Out_Count++;
+                    dec->_Bits = 0;
+                }
+            }
+            dec->_Sym = 0;
+            dec->_Sym_Bits = 0;
+        }
+    }
+}
+
+/*--------------------------------------------------------------------------------------------------------------------*/
+
+static void *_NP32_Sim_Thread(void *arg)
+{
+    NP32_Sim_t *sim = (NP32_Sim_t *) arg;
+    NP32_DMA_t *buf;
+    uint16_t len;
+
+    _NP32_Sim_Current = sim;
+
+    for (;;)
+    {
+        // Wait for the next transfer.
+        pthread_mutex_lock(&sim->_Lock);
+        while (!sim->_Start && !sim->_Quit)
+            pthread_cond_wait(&sim->_Cond, &sim->_Lock);
+        if (sim->_Quit)
+        {
+            pthread_mutex_unlock(&sim->_Lock);
+            break;
+        }
+        buf = sim->_Buf;
+        len = sim->_Len;
+        sim->_Start = 0U;
+        pthread_mutex_unlock(&sim->_Lock);
+
+        if (sim->Instance->Stream_Chunk_LEDs != 0)
+            _NP32_Sim_Run_Circular(sim, buf, len);
+        else
+            _NP32_Sim_Run_Single(sim, buf, len);
+    }
+
+    return NULL;
+}
+
+static void _NP32_Sim_Run_Single(NP32_Sim_t *sim, NP32_DMA_t *buf, uint16_t len)
+{
+    NP32_Sim_Decoder_t dec;
+    uint64_t t;
+
+    // Transmit the whole buffer, the wire contents get decoded once the transfer is complete.
+    _NP32_Sim_Sleep_Until(_NP32_Sim_Now() + ((uint64_t) len * _NP32_Sim_Unit_ns(sim)));
+    NP32_Sim_Decoder_Reset(&dec, sim->Frame_GRB, sim->Instance->LED_Count * NP32_FORMAT_BYTES(sim->Instance->Format));
+    _NP32_Sim_Decode_Units(sim, &dec, (const uint8_t *) buf, len);
+    sim->Frame_Len = dec.Out_Count;
+    sim->Frames_Sent++;
+
+    t = _NP32_Sim_Now();
+    NP32_DMAComplete_Callback(sim->Instance);
+    t = _NP32_Sim_Now() - t;
+    if (t > sim->Max_Callback_ns)
+        sim->Max_Callback_ns = t;
+}
+
+static void _NP32_Sim_Run_Circular(NP32_Sim_t *sim, NP32_DMA_t *buf, uint16_t len)
+{
+    NP32_Sim_Decoder_t dec;
+    uint64_t deadline, half_ns, t;
+    uint16_t half_len = len / 2;
+    uint8_t half = 0;
+
+    NP32_Sim_Decoder_Reset(&dec, sim->Frame_GRB, sim->Instance->LED_Count * NP32_FORMAT_BYTES(sim->Instance->Format));
+    half_ns = (uint64_t) half_len * _NP32_Sim_Unit_ns(sim);
+    deadline = _NP32_Sim_Now();
+
+    for (;;)
+    {
+        // The DMA has read the whole half at the end of its transmission time.
+        deadline += half_ns;
+        _NP32_Sim_Sleep_Until(deadline);
+        _NP32_Sim_Decode_Units(sim, &dec, (const uint8_t *) buf + ((uint32_t) half * half_len *
+                               sim->Instance->_Unit_Bytes), half_len);
+        sim->Frame_Len = dec.Out_Count;
+
+        // The callback has to refill the half before the DMA wraps around to it again.
+        t = _NP32_Sim_Now();
+        if (half == 0)
+            NP32_DMAHalfComplete_Callback(sim->Instance);
+        else
+            NP32_DMAComplete_Callback(sim->Instance);
+        t = _NP32_Sim_Now() - t;
+        if (t > sim->Max_Callback_ns)
+            sim->Max_Callback_ns = t;
+        if (t > half_ns)
+            sim->Underruns++;
+
+        // Stopped by the library, or a new frame has already been started from the callback.
+        if (sim->_Stop || sim->_Start || sim->_Quit)
+            break;
+
+        half ^= 1U;
+    }
+}
+
+static void _NP32_Sim_Decode_Units(NP32_Sim_t *sim, NP32_Sim_Decoder_t *dec, const uint8_t *buf, uint32_t units)
+{
+    switch (sim->Instance->Encoding)
+    {
+        case NP32_ENCODING_SPI3:
+            NP32_Sim_Decode_SPI(dec, buf, units, 3);
+            break;
+        case NP32_ENCODING_SPI4:
+            NP32_Sim_Decode_SPI(dec, buf, units, 4);
+            break;
+        default:
+            if (sim->Instance->Timing != NULL)
+                dec->Threshold = (sim->Instance->Timing->T0H + sim->Instance->Timing->T1H) / 2;
+            NP32_Sim_Decode(dec, (const NP32_DMA_t *) buf, units);
+            break;
+    }
+}
+
+static uint32_t _NP32_Sim_Unit_ns(NP32_Sim_t *sim)
+{
+    // A SPI byte holds 8 / 3 or 8 / 4 bits.
+    switch (sim->Instance->Encoding)
+    {
+        case NP32_ENCODING_SPI3:
+            return (sim->Period_ns * 8) / 3;
+        case NP32_ENCODING_SPI4:
+            return (sim->Period_ns * 8) / 4;
+        default:
+            return sim->Period_ns;
+    }
+}
+
+static uint64_t _NP32_Sim_Now(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ((uint64_t) ts.tv_sec * 1000000000ULL) + (uint64_t) ts.tv_nsec;
+}
+
+static void _NP32_Sim_Sleep_Until(uint64_t deadline)
+{
+    struct timespec ts;
+
+    ts.tv_sec = (time_t) (deadline / 1000000000ULL);
+    ts.tv_nsec = (long) (deadline % 1000000000ULL);
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) != 0);
+}
@@ -0,0 +1,214 @@
+// np32_seqenc.c
+// Copyright (c) 2020 Johannes Berndorfer (berndoJ)
+//
+// Host tool for coding pre-rendered shows into the sequence format of neopixel32_seq.h.
+//
+// Usage:
+//   np32_seqenc [-d duration_ms] [-k keyframe_interval] led_count in.rgb out.seq
+//       Codes the raw frames of in.rgb (led_count * 3 bytes per frame, R, G, B) into out.seq. Every
+//       keyframe_interval-th frame is coded as keyframe (default: only the first one). Seeking decodes from the last
+//       keyframe before the target frame, so a shorter interval makes seeking faster.
+//   np32_seqenc -v in.rgb in.seq
+//       Decodes in.seq with the library and compares every frame with the raw frames of in.rgb. Then seeks
+//       backwards to up to 64 frames spread over the sequence and compares them as well.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "neopixel32.h"
+#include "neopixel32_seq.h"
+
+static NP32_Instance_t *Tool_Instance;
+
+// DMA start delegate, which completes the transfer right away. The verify mode only needs the colour buffer.
+static int8_t Tool_StartDMA(NP32_DMA_t *buf, uint16_t len)
+{
+    NP32_DMAComplete_Callback(Tool_Instance);
+    return 0;
+}
+
+static uint8_t *Tool_Read_File(const char *path, uint32_t *size)
+{
+    FILE *f = fopen(path, "rb");
+    uint8_t *data;
+    long n;
+
+    if (f == NULL)
+        return NULL;
+    fseek(f, 0, SEEK_END);
+    n = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    data = (uint8_t *) malloc((n > 0) ? (size_t) n : 1);
+    if (data != NULL && fread(data, 1, (size_t) n, f) != (size_t) n)
+    {
+        free(data);
+        data = NULL;
+    }
+    fclose(f);
+    *size = (uint32_t) n;
+
+    return data;
+}
+
+static NP32_RGB_t *Tool_Frames(const uint8_t *raw, uint32_t raw_size, uint16_t led_count, uint32_t *frame_count)
+{
+    NP32_RGB_t *frames;
+    uint32_t i;
+
+    *frame_count = raw_size / ((uint32_t) led_count * 3);
+    if (*frame_count == 0 || *frame_count > 0xFFFFU || (raw_size % ((uint32_t) led_count * 3)) != 0)
+        return NULL;
+
+    frames = (NP32_RGB_t *) malloc((size_t) *frame_count * led_count * sizeof(NP32_RGB_t));
+    if (frames == NULL)
+        return NULL;
+    for (i = 0; i < *frame_count * led_count; i++)
+        frames[i] = (NP32_RGB_t){ raw[i * 3], raw[i * 3 + 1], raw[i * 3 + 2] };
+
+    return frames;
+}
+
+static int Tool_Encode(uint16_t led_count, uint16_t duration_ms, uint32_t key_interval, const char *in_path,
+                       const char *out_path)
+{
+    NP32_RGB_t *frames, *prev;
+    uint8_t *raw, *out;
+    uint32_t raw_size, frame_count, f, size = NP32_SEQ_HEADER_SIZE, keys = 0;
+    FILE *fo;
+
+    raw = Tool_Read_File(in_path, &raw_size);
+    if (raw == NULL || (frames = Tool_Frames(raw, raw_size, led_count, &frame_count)) == NULL)
+    {
+        fprintf(stderr, "np32_seqenc: cannot read frames of %u LEDs from %s\n", led_count, in_path);
+        return 1;
+    }
+    out = (uint8_t *) malloc(NP32_SEQ_HEADER_SIZE + (frame_count * NP32_SEQ_FRAME_MAX_SIZE(led_count)));
+    if (out == NULL)
+        return 1;
+
+    NP32_Seq_EncodeHeader(out, led_count, (uint16_t) frame_count);
+    for (f = 0; f < frame_count; f++)
+    {
+        prev = (f == 0 || (key_interval != 0 && (f % key_interval) == 0)) ? NULL : &frames[(f - 1) * led_count];
+        keys += (prev == NULL);
+        size += NP32_Seq_EncodeFrame(prev, &frames[f * led_count], led_count, duration_ms, out + size);
+    }
+
+    fo = fopen(out_path, "wb");
+    if (fo == NULL || fwrite(out, 1, size, fo) != size)
+    {
+        fprintf(stderr, "np32_seqenc: cannot write %s\n", out_path);
+        return 1;
+    }
+    fclose(fo);
+
+    printf("%u frames (%u keyframes), %u bytes raw, %u bytes coded (%.1f%%)\n", frame_count, keys, raw_size, size,
+           size * 100.0 / raw_size);
+
+    free(out);
+    free(frames);
+    free(raw);
+    return 0;
+}
+
+static int Tool_Verify(const char *in_path, const char *seq_path)
+{
+    NP32_Instance_t h;
+    NP32_Seq_t seq;
+    NP32_RGB_t *frames, col;
+    uint8_t *raw;
+    uint32_t raw_size, frame_count, f, s, step, errors = 0;
+    uint16_t i;
+
+    memset(&seq, 0, sizeof(NP32_Seq_t));
+    seq.Data = Tool_Read_File(seq_path, &seq.Size);
+    raw = Tool_Read_File(in_path, &raw_size);
+    if (seq.Data == NULL || raw == NULL || seq.Size < NP32_SEQ_HEADER_SIZE)
+    {
+        fprintf(stderr, "np32_seqenc: cannot read %s or %s\n", in_path, seq_path);
+        return 1;
+    }
+
+    // Decode into an instance of the LED count of the sequence.
+    memset(&h, 0, sizeof(NP32_Instance_t));
+    h.LED_Count = (uint16_t) (seq.Data[6] | (seq.Data[7] << 8));
+    h.StartDMA_Call = Tool_StartDMA;
+    Tool_Instance = &h;
+    seq.Instance = &h;
+    frames = Tool_Frames(raw, raw_size, h.LED_Count, &frame_count);
+    if (frames == NULL || NP32_Init(&h) != 0 || NP32_Seq_Init(&seq) != 0 || seq.Frame_Count != frame_count)
+    {
+        fprintf(stderr, "np32_seqenc: %s does not match %s\n", seq_path, in_path);
+        return 1;
+    }
+
+    for (f = 0; f < frame_count; f++)
+    {
+        if (NP32_Seq_Next(&seq) != 1)
+        {
+            fprintf(stderr, "np32_seqenc: frame %u is corrupt\n", f);
+            return 1;
+        }
+        for (i = 0; i < h.LED_Count; i++)
+        {
+            NP32_GetLED_RGB(&h, i, &col);
+            if (memcmp(&col, &frames[f * h.LED_Count + i], sizeof(NP32_RGB_t)) != 0)
+                errors++;
+        }
+    }
+    if (NP32_Seq_Next(&seq) != 0)
+        errors++;
+
+    // Seek backwards, so every seek has to start over from a keyframe.
+    step = (frame_count + 63) / 64;
+    for (s = frame_count; s >= step; s -= step)
+    {
+        f = s - 1;
+        if (NP32_Seq_Seek(&seq, (uint16_t) f) != 0)
+        {
+            fprintf(stderr, "np32_seqenc: cannot seek to frame %u\n", f);
+            return 1;
+        }
+        for (i = 0; i < h.LED_Count; i++)
+        {
+            NP32_GetLED_RGB(&h, i, &col);
+            if (memcmp(&col, &frames[f * h.LED_Count + i], sizeof(NP32_RGB_t)) != 0)
+                errors++;
+        }
+    }
+
+    printf("%u frames verified, %u mismatches\n", frame_count, errors);
+
+    NP32_DeInit(&h);
+    free(frames);
+    free(raw);
+    free((void *) seq.Data);
+    return (errors == 0) ? 0 : 1;
+}
+
+int main(int argc, char **argv)
+{
+    uint32_t duration_ms = 20, key_interval = 0;
+    int a = 1;
+
+    if (argc == 4 && strcmp(argv[1], "-v") == 0)
+        return Tool_Verify(argv[2], argv[3]);
+
+    for (; a + 1 < argc && argv[a][0] == '-'; a += 2)
+    {
+        if (strcmp(argv[a], "-d") == 0)
+            duration_ms = (uint32_t) strtoul(argv[a + 1], NULL, 0);
+        else if (strcmp(argv[a], "-k") == 0)
+            key_interval = (uint32_t) strtoul(argv[a + 1], NULL, 0);
+        else
+            break;
+    }
+    if (argc - a != 3 || atoi(argv[a]) <= 0 || atoi(argv[a]) > 0xFFFF || duration_ms > 0xFFFF)
+    {
+        fprintf(stderr, "usage: np32_seqenc [-d duration_ms] [-k keyframe_interval] led_count in.rgb out.seq\n"
+                        "       np32_seqenc -v in.rgb in.seq\n");
+        return 2;
+    }
+
+    return Tool_Encode((uint16_t) atoi(argv[a]), (uint16_t) duration_ms, key_interval, argv[a + 1], argv[a + 2]);
+}